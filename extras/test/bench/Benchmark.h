@@ -0,0 +1,80 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+#ifndef TEST_BENCHMARK_H_
+#define TEST_BENCHMARK_H_
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include <chrono>
+#include <stdio.h>
+#include <stddef.h>
+
+/******************************************************************************
+   TYPEDEF
+ ******************************************************************************/
+
+/* Heap usage counters, updated by the operator new and delete replacements */
+struct HeapStats
+{
+  size_t allocations;
+  size_t allocatedBytes;
+  size_t currentBytes;
+  size_t highWaterBytes;
+};
+
+/******************************************************************************
+   FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+HeapStats & heapStats();
+
+/******************************************************************************
+   FUNCTION DEFINITION
+ ******************************************************************************/
+
+/* Runs fn the requested number of times and prints the average time, the heap
+ * allocations and the allocated bytes per call and the heap high-water mark
+ * reached during the run, relative to the heap in use before the run.
+ * If bytesPerCall is not zero the throughput is printed too.
+ */
+template <typename F>
+double runBenchmark(const char *name, size_t iterations, size_t bytesPerCall, F fn)
+{
+  HeapStats before = heapStats();
+  heapStats().highWaterBytes = before.currentBytes;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    fn();
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  HeapStats after = heapStats();
+  double nsPerCall = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+  double allocsPerCall = (double)(after.allocations - before.allocations) / iterations;
+  double allocatedBytesPerCall = (double)(after.allocatedBytes - before.allocatedBytes) / iterations;
+
+  printf("%-48s %12.1f ns/op", name, nsPerCall);
+  if (bytesPerCall > 0) {
+    printf(" %10.1f MB/s", bytesPerCall * 1e3 / nsPerCall);
+  } else {
+    printf(" %15s", "");
+  }
+  printf(" %8.2f allocs/op %10.1f B/op %8zu B heap peak\n", allocsPerCall, allocatedBytesPerCall, after.highWaterBytes - before.currentBytes);
+  return nsPerCall;
+}
+
+/******************************************************************************
+   BENCHMARKS
+ ******************************************************************************/
+
+void benchPacketCRC();
+void benchPacketManager();
+void benchCBORAdapter();
+void benchBoardConfigurationProtocol();
+
+#endif /* TEST_BENCHMARK_H_ */
@@ -0,0 +1,108 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "Benchmark.h"
+#include "../../src/configuratorAgents/agents/boardConfigurationProtocol/BoardConfigurationProtocol.h"
+#include "../../src/configuratorAgents/agents/boardConfigurationProtocol/CBORAdapter.h"
+
+/******************************************************************************
+   CLASS DECLARATION
+ ******************************************************************************/
+
+/* BoardConfigurationProtocol with an in memory physical interface: the received
+ * bytes are taken from a buffer filled by the benchmark, the written bytes are counted
+ */
+class MemoryBoardConfigurationProtocol : public BoardConfigurationProtocol
+{
+public:
+  void receive(const uint8_t *data, size_t len) {
+    memcpy(_rxBuffer, data, len);
+    _rxLen = len;
+    _rxPos = 0;
+  }
+  bool update() {
+    return sendAndReceive() == TransmissionResult::DATA_RECEIVED;
+  }
+  size_t writtenBytes() {
+    return _txBytes;
+  }
+
+protected:
+  bool received() { return _rxPos < _rxLen; }
+  size_t available() { return _rxLen - _rxPos; }
+  uint8_t read() { return _rxBuffer[_rxPos++]; }
+  size_t readBytes(uint8_t *data, size_t len) {
+    if (len > available()) {
+      len = available();
+    }
+    memcpy(data, &_rxBuffer[_rxPos], len);
+    _rxPos += len;
+    return len;
+  }
+  int write(const uint8_t * /*data*/, size_t len) {
+    _txBytes += len;
+    return len;
+  }
+  void handleDisconnectRequest() { }
+  bool isPeerConnected() { return true; }
+  void clearInputBuffer() { _rxPos = _rxLen; }
+
+private:
+  uint8_t _rxBuffer[512];
+  size_t _rxLen = 0;
+  size_t _rxPos = 0;
+  size_t _txBytes = 0;
+};
+
+/******************************************************************************
+   BENCHMARK
+ ******************************************************************************/
+
+void benchBoardConfigurationProtocol()
+{
+  MemoryBoardConfigurationProtocol protocol;
+
+  /* Command GET_ID packet sent by the peer */
+  uint8_t const command[] = {0xda, 0x00, 0x01, 0x20, 0x03, 0x81, 0x02};
+  OutputPacketBuffer commandPacket;
+  PacketManager::createPacket(commandPacket, PacketManager::MessageType::DATA, command, sizeof(command));
+
+  runBenchmark("BoardConfigurationProtocol status/command loopback", 100000, 0, [&]() {
+    ProvisioningOutputMessage statusMsg = { MessageOutputType::STATUS };
+    statusMsg.m.status = StatusMessage::CONNECTED;
+    protocol.sendMsg(statusMsg);
+
+    protocol.receive(commandPacket.get_ptr(), commandPacket.len());
+    for (int i = 0; i < 10 && !protocol.update(); i++) {
+    }
+
+    ProvisioningInputMessage inputMsg;
+    inputMsg.netSetting = nullptr;
+    protocol.getMsg(inputMsg);
+  });
+
+  /* WiFi configuration packet sent by the peer, decoded in place in the destination of the receiver */
+  uint8_t const wifiConfig[] = {0xda, 0x00, 0x01, 0x20, 0x04, 0x82, 0x68, 0x53, 0x53, 0x49, 0x44, 0x2d,
+                                0x4e, 0x45, 0x54, 0x6c, 0x70, 0x61, 0x73, 0x73, 0x77, 0x6f, 0x72, 0x64,
+                                0x2d, 0x31, 0x32, 0x33};
+  OutputPacketBuffer wifiConfigPacket;
+  PacketManager::createPacket(wifiConfigPacket, PacketManager::MessageType::DATA, wifiConfig, sizeof(wifiConfig));
+  models::NetworkSetting netSetting;
+
+  runBenchmark("BoardConfigurationProtocol WiFi config received", 100000, 0, [&]() {
+    protocol.receive(wifiConfigPacket.get_ptr(), wifiConfigPacket.len());
+    for (int i = 0; i < 10 && !protocol.update(); i++) {
+    }
+
+    ProvisioningInputMessage inputMsg;
+    inputMsg.netSetting = &netSetting;
+    protocol.getMsg(inputMsg);
+  });
+
+  printf("%-48s %12zu B written\n", "", protocol.writtenBytes());
+}
@@ -0,0 +1,150 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "Benchmark.h"
+#include "../../src/configuratorAgents/agents/boardConfigurationProtocol/CBORAdapter.h"
+#include "../../src/configuratorAgents/agents/boardConfigurationProtocol/cbor/CBORInstances.h"
+#include <cbor/MessageDecoder.h>
+
+/******************************************************************************
+   BENCHMARK
+ ******************************************************************************/
+
+void benchCBORAdapter()
+{
+  uint8_t buffer[1024];
+  size_t len = 0;
+  const size_t iterations = 100000;
+
+  runBenchmark("CBORAdapter::statusToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::statusToCBOR(StatusMessage::CONNECTED, buffer, &len);
+  });
+
+  byte uhwid[MAX_UHWID_SIZE];
+  memset(uhwid, 0xca, sizeof(uhwid));
+  runBenchmark("CBORAdapter::uhwidToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::uhwidToCBOR(uhwid, buffer, &len);
+  });
+
+  char jwt[MAX_JWT_SIZE + 1];
+  memset(jwt, 'a', MAX_JWT_SIZE);
+  jwt[MAX_JWT_SIZE] = '\0';
+  runBenchmark("CBORAdapter::jwtToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::jwtToCBOR(jwt, buffer, &len);
+  });
+
+  const char provPublicKey[] = "-----BEGIN PUBLIC KEY-----\nMFkwEwYHKoZIzj0CAQYIKoZIzj0DAQcDQgAE7JxCtXl5SvIrHmiasqyN4pyoXRlm\n-----END PUBLIC KEY-----\n";
+  runBenchmark("CBORAdapter::provPublicKeyToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::provPublicKeyToCBOR(provPublicKey, buffer, &len);
+  });
+
+  uint8_t mac[BLE_MAC_ADDRESS_SIZE] = {0xaf, 0xaf, 0xaf, 0xaf, 0xaf, 0xaf};
+  runBenchmark("CBORAdapter::BLEMacAddressToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::BLEMacAddressToCBOR(mac, buffer, &len);
+  });
+
+  runBenchmark("CBORAdapter::wifiFWVersionToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::wifiFWVersionToCBOR("1.6.0", buffer, &len);
+  });
+
+  runBenchmark("CBORAdapter::provSketchVersionToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::provSketchVersionToCBOR("1.6.0", buffer, &len);
+  });
+
+  runBenchmark("CBORAdapter::netConfigLibVersionToCBOR", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::netConfigLibVersionToCBOR("1.6.0", buffer, &len);
+  });
+
+  char ssids[MAX_WIFI_NETWORKS][33];
+  WiFiOption wifiOptions;
+  wifiOptions.numDiscoveredWiFiNetworks = MAX_WIFI_NETWORKS;
+  for (int i = 0; i < MAX_WIFI_NETWORKS; i++) {
+    snprintf(ssids[i], sizeof(ssids[i]), "Network-%02d", i);
+    wifiOptions.discoveredWifiNetworks[i].SSID = ssids[i];
+    wifiOptions.discoveredWifiNetworks[i].SSIDsize = strlen(ssids[i]);
+    wifiOptions.discoveredWifiNetworks[i].RSSI = -40 - i;
+  }
+  NetworkOptions netOptions = { NetworkOptionsClass::WIFI, wifiOptions };
+  runBenchmark("CBORAdapter::networkOptionsToCBOR, 20 networks", iterations, 0, [&]() {
+    len = sizeof(buffer);
+    CBORAdapter::networkOptionsToCBOR(&netOptions, buffer, &len);
+  });
+
+  /*
+  DA 00012002             # tag(73730)
+    81                    # array(1)
+      1B 0000000067066FE4 # unsigned(1728475108)
+  */
+  uint8_t const timestampPayload[] = {0xda, 0x00, 0x01, 0x20, 0x02, 0x81, 0x1B, 0x00, 0x00,
+                                      0x00, 0x00, 0x67, 0x06, 0x6F, 0xE4};
+  ProvisioningMessageDown msg;
+  runBenchmark("CBORAdapter::getMsgFromCBOR, timestamp", iterations, sizeof(timestampPayload), [&]() {
+    CBORAdapter::getMsgFromCBOR(timestampPayload, sizeof(timestampPayload), &msg);
+  });
+
+  // Generic tinycbor based decoder, replaced by the single-pass decoder used by getMsgFromCBOR
+  CBORMessageDecoder decoder;
+  runBenchmark("CBORMessageDecoder::decode, timestamp", iterations, sizeof(timestampPayload), [&]() {
+    decoder.decode((Message *)&msg, timestampPayload, sizeof(timestampPayload));
+  });
+
+  /*
+  DA 00012004                         # tag(73732)
+    82                                # array(2)
+      68                              # text(8)
+        535349442D4E4554              # "SSID-NET"
+      6C                              # text(12)
+        70617373776F72642D313233      # "password-123"
+  */
+  uint8_t const wifiConfigPayload[] = {0xda, 0x00, 0x01, 0x20, 0x04, 0x82, 0x68, 0x53, 0x53, 0x49, 0x44, 0x2d,
+                                       0x4e, 0x45, 0x54, 0x6c, 0x70, 0x61, 0x73, 0x73, 0x77, 0x6f, 0x72, 0x64,
+                                       0x2d, 0x31, 0x32, 0x33};
+  runBenchmark("CBORAdapter::getMsgFromCBOR, WiFi config", iterations, sizeof(wifiConfigPayload), [&]() {
+    CBORAdapter::getMsgFromCBOR(wifiConfigPayload, sizeof(wifiConfigPayload), &msg);
+  });
+
+  runBenchmark("CBORMessageDecoder::decode, WiFi config", iterations, sizeof(wifiConfigPayload), [&]() {
+    decoder.decode((Message *)&msg, wifiConfigPayload, sizeof(wifiConfigPayload));
+  });
+
+  /*
+  DA 00012008                         # tag(73736)
+    85                                # array(5)
+      68                              # text(8)
+        3132333435363738              # "12345678"
+      82                              # array(2)
+        01                            # unsigned(1)
+        1A 00080000                   # unsigned(524288)
+      6E                              # text(14)
+        61706E2E61726475696E6F2E6363  # "apn.arduino.cc"
+      68                              # text(8)
+        5445535455534552              # "TESTUSER"
+      6C                              # text(12)
+        5445535450415353574F5244      # "TESTPASSWORD"
+  */
+  uint8_t const catm1ConfigPayload[] = {0xda, 0x00, 0x01, 0x20, 0x08, 0x85, 0x68, 0x31, 0x32, 0x33, 0x34, 0x35,
+                                        0x36, 0x37, 0x38, 0x82, 0x01, 0x1a, 0x00, 0x08, 0x00, 0x00, 0x6e, 0x61,
+                                        0x70, 0x6e, 0x2e, 0x61, 0x72, 0x64, 0x75, 0x69, 0x6e, 0x6f, 0x2e, 0x63,
+                                        0x63, 0x68, 0x54, 0x45, 0x53, 0x54, 0x55, 0x53, 0x45, 0x52, 0x6c, 0x54,
+                                        0x45, 0x53, 0x54, 0x50, 0x41, 0x53, 0x53, 0x57, 0x4f, 0x52, 0x44};
+  runBenchmark("CBORAdapter::getMsgFromCBOR, CATM1 config", iterations, sizeof(catm1ConfigPayload), [&]() {
+    CBORAdapter::getMsgFromCBOR(catm1ConfigPayload, sizeof(catm1ConfigPayload), &msg);
+  });
+
+  runBenchmark("CBORMessageDecoder::decode, CATM1 config", iterations, sizeof(catm1ConfigPayload), [&]() {
+    decoder.decode((Message *)&msg, catm1ConfigPayload, sizeof(catm1ConfigPayload));
+  });
+}
@@ -0,0 +1,79 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "Benchmark.h"
+#include <new>
+#include <stdlib.h>
+
+/******************************************************************************
+   GLOBAL VARIABLES
+ ******************************************************************************/
+
+static HeapStats stats = {0, 0, 0, 0};
+
+/* Each block is prefixed with its size, keeping the alignment of malloc */
+union BlockHeader
+{
+  size_t size;
+  max_align_t align;
+};
+
+/******************************************************************************
+   PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+HeapStats & heapStats()
+{
+  return stats;
+}
+
+void * operator new(size_t size)
+{
+  BlockHeader * header = (BlockHeader *)malloc(sizeof(BlockHeader) + size);
+  if (header == nullptr) {
+    throw std::bad_alloc();
+  }
+  header->size = size;
+  stats.allocations++;
+  stats.allocatedBytes += size;
+  stats.currentBytes += size;
+  if (stats.currentBytes > stats.highWaterBytes) {
+    stats.highWaterBytes = stats.currentBytes;
+  }
+  return header + 1;
+}
+
+void * operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  if (ptr == nullptr) {
+    return;
+  }
+  BlockHeader * header = (BlockHeader *)ptr - 1;
+  stats.currentBytes -= header->size;
+  free(header);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
@@ -0,0 +1,22 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "Benchmark.h"
+
+/******************************************************************************
+   MAIN
+ ******************************************************************************/
+
+int main()
+{
+  benchPacketCRC();
+  benchPacketManager();
+  benchCBORAdapter();
+  benchBoardConfigurationProtocol();
+  return 0;
+}
@@ -0,0 +1,80 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "Benchmark.h"
+#include "../../src/configuratorAgents/agents/boardConfigurationProtocol/PacketCRC.h"
+
+/******************************************************************************
+   LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/* Generic bit at a time CRC16 with the parameters passed at runtime,
+ * the same algorithm used by arduino::crc16::calculate()
+ */
+static uint16_t reflect(uint16_t value, int bits)
+{
+  uint16_t reflected = 0;
+  for (int i = 0; i < bits; i++) {
+    if (value & (1 << i)) {
+      reflected |= 1 << (bits - 1 - i);
+    }
+  }
+  return reflected;
+}
+
+static uint16_t bitwiseCRC16(const uint8_t *data, size_t len, uint16_t polynomial, uint16_t initialValue, uint16_t finalXor, bool reflectData, bool reflectResult)
+{
+  uint16_t crc = initialValue;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t byte = reflectData ? reflect(data[i], 8) : data[i];
+    crc ^= (uint16_t)byte << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ polynomial : crc << 1;
+    }
+  }
+  if (reflectResult) {
+    crc = reflect(crc, 16);
+  }
+  return crc ^ finalXor;
+}
+
+/******************************************************************************
+   BENCHMARK
+ ******************************************************************************/
+
+void benchPacketCRC()
+{
+  const size_t sizes[] = {8, 64, 512};
+  uint8_t data[512];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 31 + 7);
+  }
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    size_t len = sizes[s];
+    char name[64];
+    volatile uint16_t sink = 0;
+
+    if (PacketCRC::calculate(data, len) != bitwiseCRC16(data, len, 0x1021, 0xffff, 0xffff, true, true)) {
+      printf("CRC mismatch on %d bytes\n", (int)len);
+    }
+
+    snprintf(name, sizeof(name), "CRC16 bitwise, %d bytes", (int)len);
+    double bitwise = runBenchmark(name, 100000, len, [&]() {
+      sink = bitwiseCRC16(data, len, 0x1021, 0xffff, 0xffff, true, true);
+    });
+
+    snprintf(name, sizeof(name), "CRC16 PacketCRC table, %d bytes", (int)len);
+    double table = runBenchmark(name, 100000, len, [&]() {
+      sink = PacketCRC::calculate(data, len);
+    });
+
+    printf("%-48s %12.1fx\n", "speedup", bitwise / table);
+    (void)sink;
+  }
+}
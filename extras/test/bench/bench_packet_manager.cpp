@@ -0,0 +1,65 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "Benchmark.h"
+#include "../../src/configuratorAgents/agents/boardConfigurationProtocol/PacketManager.h"
+
+/******************************************************************************
+   BENCHMARK
+ ******************************************************************************/
+
+void benchPacketManager()
+{
+  const size_t sizes[] = {8, 256};
+  uint8_t data[256];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 31 + 7);
+  }
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    size_t len = sizes[s];
+    char name[64];
+
+    snprintf(name, sizeof(name), "PacketManager::createPacket, %d bytes", (int)len);
+    runBenchmark(name, 100000, len, [&]() {
+      OutputPacketBuffer outputMsg;
+      PacketManager::createPacket(outputMsg, PacketManager::MessageType::DATA, data, len);
+    });
+
+    OutputPacketBuffer packetMsg;
+    PacketManager::createPacket(packetMsg, PacketManager::MessageType::DATA, data, len);
+    uint8_t stream[512];
+    size_t streamLen = packetMsg.len();
+    memcpy(stream, packetMsg.get_ptr(), streamLen);
+
+    PacketManager::PacketReceiver &receiver = PacketManager::PacketReceiver::getInstance();
+    PacketManager::Packet_t packet;
+    receiver.clear(packet);
+
+    snprintf(name, sizeof(name), "PacketReceiver::handleReceivedByte, %d bytes", (int)len);
+    runBenchmark(name, 100000, streamLen, [&]() {
+      for (size_t i = 0; i < streamLen; i++) {
+        if (receiver.handleReceivedByte(packet, stream[i]) == PacketManager::ReceivingState::RECEIVED) {
+          receiver.clear(packet);
+        }
+      }
+    });
+
+    snprintf(name, sizeof(name), "PacketReceiver::handleReceivedChunk, %d bytes", (int)len);
+    runBenchmark(name, 100000, streamLen, [&]() {
+      size_t offset = 0;
+      while (offset < streamLen) {
+        size_t consumed = 0;
+        if (receiver.handleReceivedChunk(packet, &stream[offset], streamLen - offset, consumed) == PacketManager::ReceivingState::RECEIVED) {
+          receiver.clear(packet);
+        }
+        offset += consumed;
+      }
+    });
+  }
+}
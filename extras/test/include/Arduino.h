@@ -10,6 +10,8 @@
  ******************************************************************************/
 
 #include <string>
+#include <string.h>
+#include <stdint.h>
 #include <IPAddress.h>
 /******************************************************************************
    DEFINES
@@ -23,6 +25,7 @@
  ******************************************************************************/
 
 typedef std::string String;
+typedef uint8_t byte;
 
 /******************************************************************************
    FUNCTION PROTOTYPES
@@ -0,0 +1,45 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+#ifndef TEST_ARDUINO_DEBUG_UTILS_H_
+#define TEST_ARDUINO_DEBUG_UTILS_H_
+
+/******************************************************************************
+   DEFINES
+ ******************************************************************************/
+
+#define DBG_NONE    -1
+#define DBG_ERROR    0
+#define DBG_WARNING  1
+#define DBG_INFO     2
+#define DBG_DEBUG    3
+#define DBG_VERBOSE  4
+
+#define DEBUG_ERROR(...)   Debug.print(DBG_ERROR,   __VA_ARGS__)
+#define DEBUG_WARNING(...) Debug.print(DBG_WARNING, __VA_ARGS__)
+#define DEBUG_INFO(...)    Debug.print(DBG_INFO,    __VA_ARGS__)
+#define DEBUG_DEBUG(...)   Debug.print(DBG_DEBUG,   __VA_ARGS__)
+#define DEBUG_VERBOSE(...) Debug.print(DBG_VERBOSE, __VA_ARGS__)
+
+/******************************************************************************
+   CLASS DECLARATION
+ ******************************************************************************/
+
+class Arduino_DebugUtils {
+public:
+  int getDebugLevel() const { return DBG_NONE; }
+  void newlineOn() { }
+  void newlineOff() { }
+  /* The log messages are discarded */
+  template <typename... Args>
+  void print(int /*debugLevel*/, const char * /*fmt*/, Args&&... /*args*/) { }
+};
+
+/******************************************************************************
+   EXTERN DECLARATION
+ ******************************************************************************/
+
+extern Arduino_DebugUtils Debug;
+
+#endif /* TEST_ARDUINO_DEBUG_UTILS_H_ */
@@ -7,6 +7,7 @@
  ******************************************************************************/
 
 #include <Arduino.h>
+#include <Arduino_DebugUtils.h>
 
 /******************************************************************************
    GLOBAL VARIABLES
@@ -14,6 +15,8 @@
 
 static unsigned long current_millis = 0;
 
+Arduino_DebugUtils Debug;
+
 /******************************************************************************
    PUBLIC FUNCTIONS
  ******************************************************************************/
@@ -0,0 +1,426 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+ #include <catch2/catch_test_macros.hpp>
+ #include <string.h>
+ #include <vector>
+
+ #include "util/LoopbackAgent.h"
+ #include "../../src/configuratorAgents/AgentsManager.h"
+ #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/CBORAdapter.h"
+
+ /******************************************************************************
+    TEST CODE
+  ******************************************************************************/
+
+ static bool scanRequested = false;
+
+ static void scanRequestHandler() {
+   scanRequested = true;
+ }
+
+ static models::NetworkSetting receivedNetSetting;
+ static models::NetworkSetting *returnedNetSetting = nullptr;
+
+ static void networkSettingsHandler(models::NetworkSetting *netSetting) {
+   returnedNetSetting = netSetting;
+ }
+
+ static std::vector<uint64_t> receivedTimestamps;
+
+ static void timestampHandler(uint64_t ts) {
+   receivedTimestamps.push_back(ts);
+ }
+
+ static std::vector<uint8_t> timestampMessage(uint64_t ts) {
+   /* tag(0x012002) array(1) unsigned(ts) */
+   std::vector<uint8_t> msg = {0xda, 0x00, 0x01, 0x20, 0x02, 0x81, 0x1b};
+   for (int i = 7; i >= 0; i--) {
+     msg.push_back((uint8_t)(ts >> (i * 8)));
+   }
+   return msg;
+ }
+
+ static bool updateUntil(AgentsManagerStates state, int maxUpdates = 10) {
+   for (int i = 0; i < maxUpdates; i++) {
+     if (AgentsManagerClass::getInstance().update() == state) {
+       return true;
+     }
+   }
+   return false;
+ }
+
+ static bool receiveUntil(LoopbackPeer &peer, PacketManager::MessageType &type, std::vector<uint8_t> &payload, int maxUpdates = 10) {
+   for (int i = 0; i < maxUpdates; i++) {
+     if (peer.receivePacket(type, payload)) {
+       return true;
+     }
+     AgentsManagerClass::getInstance().update();
+   }
+   return false;
+ }
+
+ SCENARIO("Drive the AgentsManager through a loopback link") {
+   static LoopbackPipe toAgent;
+   static LoopbackPipe toPeer;
+   static LoopbackAgent agent(toAgent, toPeer);
+   static bool agentAdded = false;
+   LoopbackPeer peer(toPeer, toAgent);
+   AgentsManagerClass &manager = AgentsManagerClass::getInstance();
+
+   set_millis(1000);
+   toAgent.configure(LOOPBACK_PIPE_SIZE, 0, 0, 0);
+   toPeer.configure(LOOPBACK_PIPE_SIZE, 0, 0, 0);
+   toAgent.clear();
+   toPeer.clear();
+   if (!agentAdded) {
+     REQUIRE(manager.addAgent(agent));
+     agentAdded = true;
+   }
+   REQUIRE(manager.begin());
+
+   PacketManager::MessageType type;
+   std::vector<uint8_t> payload;
+
+   /* The peer connects and receives the network options */
+   REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::CONNECT));
+   REQUIRE(updateUntil(AgentsManagerStates::CONFIG_IN_PROGRESS));
+   REQUIRE(manager.getConnectedAgent() == &agent);
+   REQUIRE(receiveUntil(peer, type, payload));
+
+   NetworkOptions netOptions = { .type = NetworkOptionsClass::NONE };
+   uint8_t expected[CBOR_DATA_HEADER_LEN];
+   size_t expectedLen = sizeof(expected);
+   REQUIRE(CBORAdapter::networkOptionsToCBOR(&netOptions, expected, &expectedLen));
+   REQUIRE(type == PacketManager::MessageType::DATA);
+   REQUIRE(payload == std::vector<uint8_t>(expected, expected + expectedLen));
+
+   WHEN("The peer sends a command over a link with a small MTU")
+   {
+     toAgent.configure(5, 0, 0, 0);
+     scanRequested = false;
+     REQUIRE(manager.addRequestHandler(RequestType::SCAN, scanRequestHandler));
+     REQUIRE(peer.sendCommand(RemoteCommands::SCAN));
+     for (int i = 0; i < 10 && !scanRequested; i++) {
+       manager.update();
+     }
+
+     THEN("The request handler is fired")
+     {
+       REQUIRE(toAgent.writtenUnits() > 1);
+       REQUIRE(scanRequested);
+     }
+     manager.removeRequestHandler(RequestType::SCAN);
+   }
+
+   WHEN("A byte of the command is corrupted on the link")
+   {
+     toAgent.configure(LOOPBACK_PIPE_SIZE, 0, 0, 100);
+     toAgent.setSeed(1);
+     scanRequested = false;
+     REQUIRE(manager.addRequestHandler(RequestType::SCAN, scanRequestHandler));
+     REQUIRE(peer.sendCommand(RemoteCommands::SCAN));
+
+     THEN("The agent discards the packet and replies with a NACK")
+     {
+       REQUIRE(toAgent.corruptedUnits() == 1);
+       REQUIRE(receiveUntil(peer, type, payload));
+       REQUIRE(type == PacketManager::MessageType::TRANSMISSION_CONTROL);
+       REQUIRE(payload.size() == 1);
+       REQUIRE(payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::NACK);
+       REQUIRE_FALSE(scanRequested);
+     }
+     manager.removeRequestHandler(RequestType::SCAN);
+   }
+
+   WHEN("The peer uses the selective acknowledgement")
+   {
+     REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::NACK, 0));
+
+     THEN("Only the damaged packet is resent with its sequence number and the received packets are acknowledged")
+     {
+       REQUIRE(receiveUntil(peer, type, payload));
+       REQUIRE(type == PacketManager::MessageType::SEQUENCED_DATA);
+       REQUIRE(payload[0] == 0);
+       REQUIRE(std::vector<uint8_t>(payload.begin() + 1, payload.end()) == std::vector<uint8_t>(expected, expected + expectedLen));
+
+       REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::ACK, 0));
+       REQUIRE(peer.sendCommand(RemoteCommands::SCAN, 0));
+       REQUIRE(receiveUntil(peer, type, payload));
+       REQUIRE(type == PacketManager::MessageType::TRANSMISSION_CONTROL);
+       REQUIRE(payload == std::vector<uint8_t>{(uint8_t)PacketManager::TransmissionControlMessage::ACK, 0});
+     }
+   }
+
+   WHEN("A packet of a full window is lost on the link to the peer")
+   {
+     const StatusMessage statuses[] = {StatusMessage::SCANNING, StatusMessage::CONNECTING,
+                                       StatusMessage::FAILED_TO_CONNECT, StatusMessage::INTERNET_NOT_AVAILABLE};
+     const size_t statusCount = sizeof(statuses) / sizeof(statuses[0]);
+     REQUIRE(statusCount == BCP_SEND_WINDOW);
+
+     /* The ACK of the network options switches the agent to the selective mode */
+     REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::ACK, 0));
+     manager.update();
+
+     toPeer.dropUnit(2);
+     for (size_t i = 0; i < statusCount; i++) {
+       ProvisioningOutputMessage msg = { MessageOutputType::STATUS };
+       msg.m.status = statuses[i];
+       REQUIRE(manager.sendMsg(msg));
+     }
+
+     /* The peer delivers the packets in order: the ones following a missing packet are kept
+      * until it's received, the missing packet is requested with a NACK
+      */
+     std::vector<std::vector<uint8_t>> delivered;
+     std::vector<std::vector<uint8_t>> outOfOrder(256);
+     uint8_t nextSequence = 1;
+     bool gap = false;
+     for (int i = 0; i < 50 && delivered.size() < statusCount; i++) {
+       manager.update();
+       while (peer.receivePacket(type, payload)) {
+         if (type != PacketManager::MessageType::SEQUENCED_DATA) {
+           continue;
+         }
+         uint8_t seq = payload[0];
+         if ((uint8_t)(seq - nextSequence) >= 128) {
+           continue;
+         }
+         outOfOrder[seq].assign(payload.begin() + 1, payload.end());
+         if (seq != nextSequence) {
+           if (!gap) {
+             gap = true;
+             REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::NACK, nextSequence));
+           }
+           continue;
+         }
+         while (!outOfOrder[nextSequence].empty()) {
+           delivered.push_back(outOfOrder[nextSequence]);
+           outOfOrder[nextSequence].clear();
+           nextSequence++;
+         }
+         gap = false;
+         REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::ACK, (uint8_t)(nextSequence - 1)));
+       }
+     }
+
+     THEN("Only the lost packet is resent and every packet is delivered once")
+     {
+       REQUIRE(toPeer.lostUnits() == 1);
+       REQUIRE(delivered.size() == statusCount);
+       for (size_t i = 0; i < statusCount; i++) {
+         uint8_t status[CBOR_DATA_STATUS_LEN];
+         size_t statusLen = sizeof(status);
+         REQUIRE(CBORAdapter::statusToCBOR(statuses[i], status, &statusLen));
+         REQUIRE(delivered[i] == std::vector<uint8_t>(status, status + statusLen));
+       }
+
+       /* All the packets are acknowledged, nothing else is sent */
+       size_t writtenUnits = toPeer.writtenUnits();
+       for (int i = 0; i < 5; i++) {
+         manager.update();
+       }
+       REQUIRE(toPeer.writtenUnits() == writtenUnits);
+     }
+   }
+
+   WHEN("A packet of the peer is lost in the middle of a window")
+   {
+     const uint64_t timestamps[] = {1728475108, 1728475109, 1728475110, 1728475111};
+     receivedTimestamps.clear();
+     REQUIRE(manager.addReturnTimestampCallback(timestampHandler));
+
+     toAgent.dropUnit(2);
+     for (uint8_t seq = 0; seq < 4; seq++) {
+       std::vector<uint8_t> msg = timestampMessage(timestamps[seq]);
+       REQUIRE(peer.sendSequencedPacket(seq, msg.data(), msg.size()));
+       manager.update();
+     }
+
+     /* The peer resends only the packets requested with a NACK */
+     std::vector<uint8_t> controls;
+     size_t resent = 0;
+     for (int i = 0; i < 20; i++) {
+       manager.update();
+       while (peer.receivePacket(type, payload)) {
+         if (type != PacketManager::MessageType::TRANSMISSION_CONTROL || payload.size() != 2) {
+           continue;
+         }
+         controls.insert(controls.end(), payload.begin(), payload.end());
+         if (payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::NACK) {
+           std::vector<uint8_t> msg = timestampMessage(timestamps[payload[1]]);
+           REQUIRE(peer.sendSequencedPacket(payload[1], msg.data(), msg.size()));
+           resent++;
+         }
+       }
+     }
+
+     /* A duplicate of a packet already received */
+     std::vector<uint8_t> msg = timestampMessage(timestamps[2]);
+     REQUIRE(peer.sendSequencedPacket(2, msg.data(), msg.size()));
+     std::vector<uint8_t> duplicateAck;
+     for (int i = 0; i < 5 && duplicateAck.empty(); i++) {
+       manager.update();
+       while (peer.receivePacket(type, payload)) {
+         if (type == PacketManager::MessageType::TRANSMISSION_CONTROL) {
+           duplicateAck = payload;
+         }
+       }
+     }
+
+     THEN("Only the lost packet is resent and every timestamp is delivered once and in order")
+     {
+       const uint8_t ACK = (uint8_t)PacketManager::TransmissionControlMessage::ACK;
+       const uint8_t NACK = (uint8_t)PacketManager::TransmissionControlMessage::NACK;
+       REQUIRE(toAgent.lostUnits() == 1);
+       REQUIRE(resent == 1);
+       REQUIRE(controls == std::vector<uint8_t>{ACK, 0, NACK, 1, ACK, 3});
+       REQUIRE(duplicateAck == std::vector<uint8_t>{ACK, 3});
+       REQUIRE(receivedTimestamps == std::vector<uint64_t>(timestamps, timestamps + 4));
+     }
+     manager.removeReturnTimestampCallback();
+   }
+
+   WHEN("The agent sends more messages than the output queue holds to a peer without the selective mode")
+   {
+     const size_t count = BCP_OUTPUT_QUEUE_DEPTH + 4;
+     uint8_t status[CBOR_DATA_STATUS_LEN];
+     size_t statusLen = sizeof(status);
+     REQUIRE(CBORAdapter::statusToCBOR(StatusMessage::CONNECTING, status, &statusLen));
+
+     /* The peer doesn't send anything, so the sent packets are never released by a received message */
+     size_t sent = 0;
+     size_t delivered = 0;
+     for (size_t i = 0; i < count; i++) {
+       ProvisioningOutputMessage msg = { MessageOutputType::STATUS };
+       msg.m.status = StatusMessage::CONNECTING;
+       if (manager.sendMsg(msg)) {
+         sent++;
+       }
+       for (int j = 0; j < 3; j++) {
+         manager.update();
+         while (peer.receivePacket(type, payload)) {
+           if (type == PacketManager::MessageType::DATA && payload == std::vector<uint8_t>(status, status + statusLen)) {
+             delivered++;
+           }
+         }
+       }
+     }
+
+     THEN("The packets already sent make room for the new ones and every message is delivered")
+     {
+       REQUIRE(sent == count);
+       REQUIRE(delivered == count);
+     }
+   }
+
+   WHEN("The peer sends the same invalid command twice")
+   {
+     uint8_t status[CBOR_DATA_STATUS_LEN];
+     size_t statusLen = sizeof(status);
+     REQUIRE(CBORAdapter::statusToCBOR(StatusMessage::INVALID_REQUEST, status, &statusLen));
+
+     THEN("The agent replies twice with the same status packet")
+     {
+       for (int i = 0; i < 2; i++) {
+         REQUIRE(peer.sendCommand((RemoteCommands)55));
+         REQUIRE(receiveUntil(peer, type, payload));
+         REQUIRE(type == PacketManager::MessageType::DATA);
+         REQUIRE(payload == std::vector<uint8_t>(status, status + statusLen));
+       }
+     }
+   }
+
+   WHEN("The peer sends a WiFi configuration")
+   {
+     /* tag(0x012004) array(2) text("SSID1") text("PASSWORDSSID1") */
+     uint8_t const wifiConfig[] = {0xda, 0x00, 0x01, 0x20, 0x04, 0x82, 0x65, 0x53,
+                                   0x53, 0x49, 0x44, 0x31, 0x6d, 0x50, 0x41, 0x53,
+                                   0x53, 0x57, 0x4f, 0x52, 0x44, 0x53, 0x53, 0x49,
+                                   0x44, 0x31};
+     memset(&receivedNetSetting, 0x00, sizeof(receivedNetSetting));
+     returnedNetSetting = nullptr;
+     REQUIRE(manager.addReturnNetworkSettingsCallback(networkSettingsHandler, &receivedNetSetting));
+     REQUIRE(peer.sendPacket(PacketManager::MessageType::DATA, wifiConfig, sizeof(wifiConfig)));
+     for (int i = 0; i < 10 && returnedNetSetting == nullptr; i++) {
+       manager.update();
+     }
+
+     THEN("The network settings are decoded in the destination of the callback")
+     {
+       REQUIRE(returnedNetSetting == &receivedNetSetting);
+       REQUIRE(receivedNetSetting.type == NetworkAdapter::WIFI);
+       REQUIRE(strcmp(receivedNetSetting.wifi.ssid, "SSID1") == 0);
+       REQUIRE(strcmp(receivedNetSetting.wifi.pwd, "PASSWORDSSID1") == 0);
+     }
+     manager.removeReturnNetworkSettingsCallback();
+   }
+
+   WHEN("The peer is disconnected with packets still queued")
+   {
+     const StatusMessage statuses[] = {StatusMessage::SCANNING, StatusMessage::CONNECTING};
+     for (size_t i = 0; i < 2; i++) {
+       ProvisioningOutputMessage msg = { MessageOutputType::STATUS };
+       msg.m.status = statuses[i];
+       REQUIRE(manager.sendMsg(msg));
+     }
+     size_t writtenUnits = toPeer.writtenUnits();
+     manager.disconnect();
+
+     THEN("The disconnection doesn't wait for the output, the queued packets and the DISCONNECT message are written by the following updates")
+     {
+       REQUIRE(toPeer.writtenUnits() == writtenUnits);
+       REQUIRE_FALSE(agent.isPeerConnected());
+
+       for (size_t i = 0; i < 2; i++) {
+         uint8_t status[CBOR_DATA_STATUS_LEN];
+         size_t statusLen = sizeof(status);
+         REQUIRE(CBORAdapter::statusToCBOR(statuses[i], status, &statusLen));
+         REQUIRE(receiveUntil(peer, type, payload));
+         REQUIRE(type == PacketManager::MessageType::DATA);
+         REQUIRE(payload == std::vector<uint8_t>(status, status + statusLen));
+       }
+       REQUIRE(receiveUntil(peer, type, payload));
+       REQUIRE(type == PacketManager::MessageType::TRANSMISSION_CONTROL);
+       REQUIRE(payload == std::vector<uint8_t>{(uint8_t)PacketManager::TransmissionControlMessage::DISCONNECT});
+
+       /* Nothing else is written, the peer can connect again */
+       writtenUnits = toPeer.writtenUnits();
+       REQUIRE_FALSE(receiveUntil(peer, type, payload));
+       REQUIRE(toPeer.writtenUnits() == writtenUnits);
+       REQUIRE(peer.sendControl(PacketManager::TransmissionControlMessage::CONNECT));
+       REQUIRE(updateUntil(AgentsManagerStates::CONFIG_IN_PROGRESS));
+       REQUIRE(receiveUntil(peer, type, payload));
+       REQUIRE(type == PacketManager::MessageType::DATA);
+       REQUIRE(payload == std::vector<uint8_t>(expected, expected + expectedLen));
+     }
+   }
+
+   WHEN("The link to the peer has a latency")
+   {
+     toPeer.configure(LOOPBACK_PIPE_SIZE, 50, 0, 0);
+     set_millis(2000);
+     manager.disconnect();
+     manager.update();
+
+     THEN("The packets are readable only after the latency elapsed")
+     {
+       REQUIRE_FALSE(peer.receivePacket(type, payload));
+       set_millis(2049);
+       REQUIRE_FALSE(peer.receivePacket(type, payload));
+       set_millis(2050);
+       REQUIRE(peer.receivePacket(type, payload));
+       REQUIRE(type == PacketManager::MessageType::TRANSMISSION_CONTROL);
+       REQUIRE(payload.size() == 1);
+       REQUIRE(payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::DISCONNECT);
+     }
+   }
+
+   manager.end();
+ }
@@ -0,0 +1,64 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+ #include <catch2/catch_test_macros.hpp>
+
+ #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/PacketCRC.h"
+
+ /******************************************************************************
+    TEST CODE
+  ******************************************************************************/
+
+ SCENARIO("Test the CRC16 of the packets") {
+   /****************************************************************************/
+
+   WHEN("Compute the CRC of the standard check string")
+   {
+     uint8_t const data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+     THEN("The CRC is the CRC-16/X-25 check value") {
+       REQUIRE(PacketCRC::calculate(data, sizeof(data)) == 0x906E);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Compute the CRC of an empty buffer")
+   {
+     THEN("The CRC is the initial value with the final XOR applied") {
+       REQUIRE(PacketCRC::calculate(nullptr, 0) == 0x0000);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Compute the CRC of a status message")
+   {
+     uint8_t const data[] = {0xda, 0x00, 0x01, 0x20, 0x00, 0x81, 0x38, 0x63};
+
+     THEN("The CRC matches the expected value") {
+       REQUIRE(PacketCRC::calculate(data, sizeof(data)) == 0x4BBE);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Compute the CRC incrementally")
+   {
+     uint8_t const data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+     uint16_t crc = PacketCRC::begin();
+     crc = PacketCRC::update(crc, &data[0], 2);
+     crc = PacketCRC::update(crc, &data[2], 0);
+     crc = PacketCRC::update(crc, &data[2], 6);
+     crc = PacketCRC::update(crc, &data[8], 1);
+
+     THEN("The CRC is the same of the single pass computation") {
+       REQUIRE(PacketCRC::finalize(crc) == PacketCRC::calculate(data, sizeof(data)));
+     }
+   }
+ }
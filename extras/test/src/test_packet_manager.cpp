@@ -0,0 +1,356 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+ #include <catch2/catch_test_macros.hpp>
+ #include <string.h>
+ #include <vector>
+
+ #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/PacketManager.h"
+
+ /******************************************************************************
+    TEST CODE
+  ******************************************************************************/
+
+ SCENARIO("Test the reception of the packets") {
+   PacketManager::PacketReceiver &receiver = PacketManager::PacketReceiver::getInstance();
+   PacketManager::Packet_t packet;
+   receiver.clear(packet);
+
+   uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x00, 0x81, 0x38, 0x63};
+   OutputPacketBuffer outputMsg;
+   REQUIRE(PacketManager::createPacket(outputMsg, PacketManager::MessageType::DATA, payload, sizeof(payload)));
+
+   uint8_t stream[32];
+   size_t streamLen = outputMsg.len();
+   memcpy(stream, outputMsg.get_ptr(), streamLen);
+
+   /****************************************************************************/
+
+   WHEN("The packet is received in a single chunk")
+   {
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, stream, streamLen, consumed);
+
+     THEN("The packet is received and the payload is available") {
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(consumed == streamLen);
+       REQUIRE(packet.Type == PacketManager::MessageType::DATA);
+       REQUIRE(packet.Payload.len() == sizeof(payload));
+       REQUIRE(memcmp(packet.Payload.get_ptr(), payload, sizeof(payload)) == 0);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The packet is received byte by byte")
+   {
+     PacketManager::ReceivingState res = PacketManager::ReceivingState::WAITING_HEADER;
+     for (size_t i = 0; i < streamLen; i++) {
+       res = receiver.handleReceivedByte(packet, stream[i]);
+     }
+
+     THEN("The packet is received and the payload is available") {
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(packet.Payload.len() == sizeof(payload));
+       REQUIRE(memcmp(packet.Payload.get_ptr(), payload, sizeof(payload)) == 0);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The payload is corrupted")
+   {
+     stream[7] ^= 0x01;
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, stream, streamLen, consumed);
+
+     THEN("The packet is rejected as soon as the CRC is received") {
+       REQUIRE(res == PacketManager::ReceivingState::ERROR);
+       REQUIRE(consumed == streamLen - 2);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The end of the packet is wrong")
+   {
+     stream[streamLen - 1] = 0x00;
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, stream, streamLen, consumed);
+
+     THEN("The packet is rejected") {
+       REQUIRE(res == PacketManager::ReceivingState::ERROR);
+     }
+   }
+
+   receiver.clear(packet);
+ }
+
+ SCENARIO("Test the synchronization on the start of the packets") {
+   PacketManager::PacketReceiver &receiver = PacketManager::PacketReceiver::getInstance();
+   PacketManager::Packet_t packet;
+   receiver.clear(packet);
+
+   uint8_t const payload[] = {0x01, 0x02, 0x03};
+   OutputPacketBuffer outputMsg;
+   REQUIRE(PacketManager::createPacket(outputMsg, PacketManager::MessageType::DATA, payload, sizeof(payload)));
+
+   /****************************************************************************/
+
+   WHEN("The packet is preceded by garbage bytes")
+   {
+     uint8_t const garbage[] = {0x00, 0x55, 0x12, 0xaa, 0x55, 0x55};
+     uint8_t stream[32];
+     memcpy(stream, garbage, sizeof(garbage));
+     memcpy(&stream[sizeof(garbage)], outputMsg.get_ptr(), outputMsg.len());
+     size_t streamLen = sizeof(garbage) + outputMsg.len();
+
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, stream, streamLen, consumed);
+
+     THEN("The garbage is discarded and the packet is received") {
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(consumed == streamLen);
+       REQUIRE(packet.Payload.len() == sizeof(payload));
+       REQUIRE(memcmp(packet.Payload.get_ptr(), payload, sizeof(payload)) == 0);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The reception starts in the middle of a packet")
+   {
+     uint8_t stream[32];
+     size_t tailLen = outputMsg.len() - 3;
+     memcpy(stream, outputMsg.get_ptr() + 3, tailLen);
+     memcpy(&stream[tailLen], outputMsg.get_ptr(), outputMsg.len());
+     size_t streamLen = tailLen + outputMsg.len();
+
+     PacketManager::ReceivingState res = PacketManager::ReceivingState::WAITING_HEADER;
+     for (size_t i = 0; i < streamLen; i++) {
+       res = receiver.handleReceivedByte(packet, stream[i]);
+       if (i < streamLen - 1) {
+         REQUIRE(res != PacketManager::ReceivingState::ERROR);
+       }
+     }
+
+     THEN("The following packet is received") {
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(memcmp(packet.Payload.get_ptr(), payload, sizeof(payload)) == 0);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The garbage contains a false start marker whose packet overlaps the valid one")
+   {
+     // The false packet declares 4 bytes of payload, it takes the start of the valid packet and fails the CRC
+     uint8_t const garbage[] = {0x55, 0xaa, 0x02, 0x00, 0x06, 0x11};
+     uint8_t stream[32];
+     memcpy(stream, garbage, sizeof(garbage));
+     memcpy(&stream[sizeof(garbage)], outputMsg.get_ptr(), outputMsg.len());
+     size_t streamLen = sizeof(garbage) + outputMsg.len();
+
+     THEN("The bytes after the false start marker are scanned again and the packet is received") {
+       for (size_t chunkSize : {streamLen, (size_t)1, (size_t)4}) {
+         receiver.reset(packet);
+         PacketManager::ReceivingState res = PacketManager::ReceivingState::WAITING_HEADER;
+         size_t offset = 0;
+         int errors = 0;
+         while (offset < streamLen || receiver.hasPendingBytes(packet)) {
+           size_t consumed = 0;
+           size_t len = streamLen - offset < chunkSize ? streamLen - offset : chunkSize;
+           res = receiver.handleReceivedChunk(packet, &stream[offset], len, consumed);
+           offset += consumed;
+           if (res == PacketManager::ReceivingState::RECEIVED) {
+             break;
+           }
+           if (res == PacketManager::ReceivingState::ERROR) {
+             errors++;
+           }
+         }
+
+         REQUIRE(errors == 1);
+         REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+         REQUIRE(offset == streamLen);
+         REQUIRE(packet.Payload.len() == sizeof(payload));
+         REQUIRE(memcmp(packet.Payload.get_ptr(), payload, sizeof(payload)) == 0);
+       }
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The garbage contains a false start marker with an invalid length")
+   {
+     uint8_t const garbage[] = {0x55, 0xaa, 0x02, 0xff};
+     uint8_t stream[32];
+     memcpy(stream, garbage, sizeof(garbage));
+     memcpy(&stream[sizeof(garbage)], outputMsg.get_ptr(), outputMsg.len());
+     size_t streamLen = sizeof(garbage) + outputMsg.len();
+
+     PacketManager::ReceivingState res = PacketManager::ReceivingState::WAITING_HEADER;
+     size_t offset = 0;
+     while (offset < streamLen || receiver.hasPendingBytes(packet)) {
+       size_t consumed = 0;
+       res = receiver.handleReceivedChunk(packet, &stream[offset], streamLen - offset, consumed);
+       offset += consumed;
+       if (res == PacketManager::ReceivingState::RECEIVED) {
+         break;
+       }
+     }
+
+     THEN("The start marker of the valid packet consumed by the false header is found again") {
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(memcmp(packet.Payload.get_ptr(), payload, sizeof(payload)) == 0);
+     }
+   }
+
+   receiver.reset(packet);
+ }
+
+ SCENARIO("Test the validation of the packet length") {
+   PacketManager::PacketReceiver &receiver = PacketManager::PacketReceiver::getInstance();
+   PacketManager::Packet_t packet;
+   receiver.clear(packet);
+
+   /****************************************************************************/
+
+   WHEN("The length is shorter than the CRC")
+   {
+     uint8_t const header[] = {0x55, 0xaa, 0x02, 0x00, 0x01};
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, header, sizeof(header), consumed);
+
+     THEN("The packet is rejected") {
+       REQUIRE(res == PacketManager::ReceivingState::INVALID_LENGTH);
+       REQUIRE(consumed == sizeof(header));
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("The packet exceeds the maximum frame size")
+   {
+     uint8_t const header[] = {0x55, 0xaa, 0x02, 0xff, 0xff};
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, header, sizeof(header), consumed);
+
+     THEN("The packet is rejected before buffering the payload") {
+       REQUIRE(res == PacketManager::ReceivingState::INVALID_LENGTH);
+       REQUIRE(PacketPool::getInstance().freeSlots() == BCP_PACKET_POOL_SLOTS);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("A valid packet follows a rejected one")
+   {
+     uint8_t const header[] = {0x55, 0xaa, 0x02, 0x00, 0x00};
+     uint8_t const payload[] = {0x01};
+     OutputPacketBuffer outputMsg;
+     REQUIRE(PacketManager::createPacket(outputMsg, PacketManager::MessageType::DATA, payload, sizeof(payload)));
+
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, header, sizeof(header), consumed);
+     REQUIRE(res == PacketManager::ReceivingState::INVALID_LENGTH);
+     res = receiver.handleReceivedChunk(packet, outputMsg.get_ptr(), outputMsg.len(), consumed);
+
+     THEN("The valid packet is received") {
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(packet.Payload.len() == sizeof(payload));
+     }
+   }
+
+   receiver.clear(packet);
+ }
+
+ SCENARIO("Test the creation of a packet in place") {
+   uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x00, 0x81, 0x38, 0x63};
+   OutputPacketBuffer expectedMsg;
+   REQUIRE(PacketManager::createPacket(expectedMsg, PacketManager::MessageType::DATA, payload, sizeof(payload)));
+
+   WHEN("The payload is written in the reserved packet")
+   {
+     OutputPacketBuffer outputMsg;
+     uint8_t *data = PacketManager::reservePacket(outputMsg, 64);
+     REQUIRE(data != nullptr);
+     memcpy(data, payload, sizeof(payload));
+
+     THEN("The finalized packet is equal to the one created from a copy of the payload") {
+       REQUIRE(PacketManager::finalizePacket(outputMsg, PacketManager::MessageType::DATA, sizeof(payload)));
+       REQUIRE(outputMsg.len() == expectedMsg.len());
+       REQUIRE(memcmp(outputMsg.get_ptr(), expectedMsg.get_ptr(), expectedMsg.len()) == 0);
+     }
+   }
+
+   WHEN("The payload exceeds the reserved size")
+   {
+     OutputPacketBuffer outputMsg;
+     REQUIRE(PacketManager::reservePacket(outputMsg, 4) != nullptr);
+
+     THEN("The packet is not finalized") {
+       REQUIRE_FALSE(PacketManager::finalizePacket(outputMsg, PacketManager::MessageType::DATA, sizeof(payload)));
+     }
+   }
+ }
+
+ SCENARIO("Test the exhaustion of the packet pool") {
+   PacketManager::PacketReceiver &receiver = PacketManager::PacketReceiver::getInstance();
+   PacketManager::Packet_t packet;
+   receiver.clear(packet);
+
+   uint8_t payload[100];
+   memset(payload, 0x01, sizeof(payload));
+   OutputPacketBuffer outputMsg;
+   REQUIRE(PacketManager::createPacket(outputMsg, PacketManager::MessageType::DATA, payload, sizeof(payload)));
+
+   /****************************************************************************/
+
+   WHEN("A small packet is created")
+   {
+     size_t freeSlots = PacketPool::getInstance().freeSlots();
+     OutputPacketBuffer smallMsg;
+     REQUIRE(PacketManager::createPacket(smallMsg, PacketManager::MessageType::DATA, payload, 32));
+
+     THEN("It doesn't take a buffer sized for the big packets") {
+       REQUIRE(PacketPool::getInstance().freeSlots() == freeSlots);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("A packet is received while all the buffers are in use")
+   {
+     std::vector<uint8_t *> buffers;
+     uint8_t *buf = nullptr;
+     while ((buf = PacketPool::getInstance().acquire(sizeof(payload))) != nullptr) {
+       buffers.push_back(buf);
+     }
+
+     size_t consumed = 0;
+     PacketManager::ReceivingState res = receiver.handleReceivedChunk(packet, outputMsg.get_ptr(), outputMsg.len(), consumed);
+
+     THEN("The packet is dropped after the header with a distinct error") {
+       REQUIRE(res == PacketManager::ReceivingState::NO_BUFFER);
+       REQUIRE(consumed == 5);
+     }
+
+     for (uint8_t *b : buffers) {
+       PacketPool::getInstance().release(b);
+     }
+
+     THEN("The packet is received once the buffers are released") {
+       res = receiver.handleReceivedChunk(packet, outputMsg.get_ptr(), outputMsg.len(), consumed);
+       REQUIRE(res == PacketManager::ReceivingState::RECEIVED);
+       REQUIRE(packet.Payload.len() == sizeof(payload));
+     }
+   }
+
+   receiver.clear(packet);
+ }
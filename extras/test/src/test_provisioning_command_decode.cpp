@@ -15,6 +15,7 @@
  #include <cbor/MessageDecoder.h>
  #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/cbor/CBOR.h"
  #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/cbor/CBORInstances.h"
+ #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/cbor/ProvisioningMessageDecoder.h"
  #include <IPAddress.h>
 
  /******************************************************************************
@@ -755,3 +756,155 @@ WHEN("Decode a provisioning Ethernet with defaults and DHCP")
    }
 
  }
+
+ SCENARIO("Test the single-pass decoding of command messages") {
+   /****************************************************************************/
+
+   WHEN("Decode the same messages with the single-pass and the generic decoder")
+   {
+     // timestamp, command, WiFi, LoRa with defaults, CATM1 without bands, Ethernet with defaults, GSM and Cellular
+     uint8_t const timestampPayload[] = {0xda, 0x00, 0x01, 0x20, 0x02, 0x81, 0x1B, 0x00, 0x00,
+                                         0x00, 0x00, 0x67, 0x06, 0x6F, 0xE4};
+     uint8_t const commandPayload[] = {0xda, 0x00, 0x01, 0x20, 0x03, 0x81, 0x18, 0x64};
+     uint8_t const wifiPayload[] = {0xda, 0x00, 0x01, 0x20, 0x04, 0x82, 0x65, 0x53,
+                                    0x53, 0x49, 0x44, 0x31, 0x6d, 0x50, 0x41, 0x53,
+                                    0x53, 0x57, 0x4f, 0x52, 0x44, 0x53, 0x53, 0x49,
+                                    0x44, 0x31};
+     uint8_t const loraPayload[] = {0xda, 0x00, 0x01, 0x20, 0x05, 0x85, 0x67, 0x41,
+                                    0x50, 0x50, 0x45, 0x55, 0x49, 0x31, 0x66, 0x41,
+                                    0x50, 0x50, 0x4B, 0x45, 0x59, 0x20, 0x60, 0x60};
+     uint8_t const catm1Payload[] = {0xda, 0x00, 0x01, 0x20, 0x08, 0x85, 0x68, 0x31,
+                                     0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x80,
+                                     0x6E, 0x61, 0x70, 0x6E, 0x2E, 0x61, 0x72, 0x64,
+                                     0x75, 0x69, 0x6E, 0x6F, 0x2E, 0x63, 0x63, 0x60,
+                                     0x60};
+     uint8_t const ethernetPayload[] = {0xda, 0x00, 0x01, 0x20, 0x09, 0x86, 0x44, 0xC0,
+                                        0xA8, 0x00, 0x02, 0x40, 0x40, 0x40, 0x20, 0x18,
+                                        0xC8};
+     uint8_t const gsmPayload[] = {0xda, 0x00, 0x01, 0x20, 0x06, 0x84, 0x60, 0x6e,
+                                   0x61, 0x70, 0x6e, 0x2e, 0x61, 0x72, 0x64, 0x75,
+                                   0x69, 0x6e, 0x6f, 0x2e, 0x63, 0x63, 0x60, 0x60};
+     uint8_t const cellularPayload[] = {0xda, 0x00, 0x01, 0x20, 0x12, 0x84, 0x68, 0x31,
+                                        0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x6e,
+                                        0x61, 0x70, 0x6e, 0x2e, 0x61, 0x72, 0x64, 0x75,
+                                        0x69, 0x6e, 0x6f, 0x2e, 0x63, 0x63, 0x68, 0x54,
+                                        0x45, 0x53, 0x54, 0x55, 0x53, 0x45, 0x52, 0x6c,
+                                        0x54, 0x45, 0x53, 0x54, 0x50, 0x41, 0x53, 0x53,
+                                        0x57, 0x4f, 0x52, 0x44};
+     struct { const uint8_t *data; size_t len; } const payloads[] = {
+       {timestampPayload, sizeof(timestampPayload)},
+       {commandPayload, sizeof(commandPayload)},
+       {wifiPayload, sizeof(wifiPayload)},
+       {loraPayload, sizeof(loraPayload)},
+       {catm1Payload, sizeof(catm1Payload)},
+       {ethernetPayload, sizeof(ethernetPayload)},
+       {gsmPayload, sizeof(gsmPayload)},
+       {cellularPayload, sizeof(cellularPayload)}
+     };
+
+     THEN("The decoded messages are the same") {
+       for (size_t i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++) {
+         ProvisioningMessageDown expected;
+         ProvisioningMessageDown command;
+         memset(&expected, 0x00, sizeof(expected));
+         memset(&command, 0x00, sizeof(command));
+
+         CBORMessageDecoder decoder;
+         REQUIRE(decoder.decode((Message*)&expected, payloads[i].data, payloads[i].len) == MessageDecoder::Status::Complete);
+         REQUIRE(ProvisioningMessageDecoder::decode(&command, payloads[i].data, payloads[i].len) == MessageDecoder::Status::Complete);
+         REQUIRE(memcmp(&command, &expected, sizeof(command)) == 0);
+       }
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Decode a truncated message")
+   {
+     ProvisioningMessageDown command;
+     // WiFi configuration message without the last byte of the password
+     uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x04, 0x82, 0x65, 0x53,
+                                0x53, 0x49, 0x44, 0x31, 0x6d, 0x50, 0x41, 0x53,
+                                0x53, 0x57, 0x4f, 0x52, 0x44, 0x53, 0x53, 0x49,
+                                0x44};
+     MessageDecoder::Status err = ProvisioningMessageDecoder::decode(&command, payload, sizeof(payload));
+
+     THEN("The decode is error") {
+       REQUIRE(err == MessageDecoder::Status::Error);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Decode a message with an unknown tag")
+   {
+     ProvisioningMessageDown command;
+     // Status message, it's only sent by the board
+     uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x00, 0x81, 0x01};
+     MessageDecoder::Status err = ProvisioningMessageDecoder::decode(&command, payload, sizeof(payload));
+
+     THEN("The decode is error") {
+       REQUIRE(err == MessageDecoder::Status::Error);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Decode a message with a tag in the range of the received messages but sent by the board")
+   {
+     ProvisioningMessageDown command;
+     // Unique hardware id message with an empty byte string
+     uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x10, 0x81, 0x40};
+     MessageDecoder::Status err = ProvisioningMessageDecoder::decode(&command, payload, sizeof(payload));
+
+     THEN("The decode is error") {
+       REQUIRE(err == MessageDecoder::Status::Error);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Decode a WiFi configuration message in place")
+   {
+     ProvisioningValueMessageDown command;
+     models::NetworkSetting netSetting;
+     memset(&netSetting, 0x00, sizeof(netSetting));
+     uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x04, 0x82, 0x65, 0x53,
+                                0x53, 0x49, 0x44, 0x31, 0x6d, 0x50, 0x41, 0x53,
+                                0x53, 0x57, 0x4f, 0x52, 0x44, 0x53, 0x53, 0x49,
+                                0x44, 0x31};
+     MessageDecoder::Status err = ProvisioningMessageDecoder::decode(&command, &netSetting, payload, sizeof(payload));
+
+     THEN("The network setting is written in the destination") {
+       REQUIRE(err == MessageDecoder::Status::Complete);
+       REQUIRE(command.c.id == ProvisioningMessageId::WifiConfigProvisioningMessageId);
+       REQUIRE(netSetting.type == NetworkAdapter::WIFI);
+       REQUIRE(strcmp(netSetting.wifi.ssid, "SSID1") == 0);
+       REQUIRE(strcmp(netSetting.wifi.pwd, "PASSWORDSSID1") == 0);
+     }
+
+     THEN("A truncated message leaves the destination not valid") {
+       REQUIRE(err == MessageDecoder::Status::Complete);
+       REQUIRE(ProvisioningMessageDecoder::decode(&command, &netSetting, payload, sizeof(payload) - 1) == MessageDecoder::Status::Error);
+       REQUIRE(netSetting.type == NetworkAdapter::NONE);
+     }
+   }
+
+   /****************************************************************************/
+
+   WHEN("Decode a CATM1 configuration message with more bands than allowed")
+   {
+     ProvisioningMessageDown command;
+     // pin "12345678", 5 bands, apn "apn.arduino.cc", login and password empty
+     uint8_t const payload[] = {0xda, 0x00, 0x01, 0x20, 0x08, 0x85, 0x68, 0x31,
+                                0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x85,
+                                0x01, 0x02, 0x03, 0x04, 0x05, 0x6E, 0x61, 0x70,
+                                0x6E, 0x2E, 0x61, 0x72, 0x64, 0x75, 0x69, 0x6E,
+                                0x6F, 0x2E, 0x63, 0x63, 0x60, 0x60};
+     MessageDecoder::Status err = ProvisioningMessageDecoder::decode(&command, payload, sizeof(payload));
+
+     THEN("The decode is error") {
+       REQUIRE(err == MessageDecoder::Status::Error);
+     }
+   }
+ }
@@ -13,6 +13,7 @@
  #include <cbor/MessageEncoder.h>
  #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/cbor/CBOR.h"
  #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/cbor/CBORInstances.h"
+ #include "../../src/configuratorAgents/agents/boardConfigurationProtocol/CBORAdapter.h"
 
  /******************************************************************************
     TEST CODE
@@ -88,6 +89,46 @@
     }
    }
 
+   WHEN("Encode a message with provisioning wifi list update ")
+   {
+    WifiNetworksUpdateProvisioningMessage command;
+    command.c.id = ProvisioningMessageId::WifiNetworksUpdateProvisioningMessageId;
+    command.numDiscoveredWiFiNetworks = 2;
+    char ssid1[] = "SSID1";
+    int rssi1 = -76;
+    command.discoveredWifiNetworks[0].SSID = ssid1;
+    command.discoveredWifiNetworks[0].RSSI = &rssi1;
+    char ssid2[] = "SSID2";
+    int rssi2 = -56;
+    command.discoveredWifiNetworks[1].SSID = ssid2;
+    command.discoveredWifiNetworks[1].RSSI = &rssi2;
+
+    uint8_t buffer[512];
+    size_t bytes_encoded = sizeof(buffer);
+
+    CBORMessageEncoder encoder;
+    MessageEncoder::Status err = encoder.encode((Message*)&command, buffer, bytes_encoded);
+
+    uint8_t expected_result[] = {
+    0xda, 0x00, 0x01, 0x20, 0x18, 0x84, 0x65, 0x53, 0x53, 0x49, 0x44, 0x31, 0x38, 0x4B, 0x65, 0x53, 0x53, 0x49, 0x44, 0x32, 0x38, 0x37
+    };
+
+    // Test the encoding is
+    //DA 00012018        # tag(73752)
+    //  84               # array(4)
+    //     65            # text(5)
+    //        5353494431 # "SSID1"
+    //     38 4B         # negative(75)
+    //     65            # text(5)
+    //        5353494432 # "SSID2"
+    //     38 37         # negative(55)
+    THEN("The encoding is successful") {
+        REQUIRE(err == MessageEncoder::Status::Complete);
+        REQUIRE(bytes_encoded == sizeof(expected_result));
+        REQUIRE(memcmp(buffer, expected_result, sizeof(expected_result)) == 0);
+    }
+   }
+
    WHEN("Encode a message with provisioning uniqueHardwareId ")
    {
     UniqueHardwareIdProvisioningMessage command;
@@ -323,3 +364,100 @@
     }
    }
  }
+
+ SCENARIO("Test the CBOR templates of the messages with a fixed shape") {
+   CBORMessageEncoder encoder;
+   uint8_t expected[64];
+   size_t expectedLen = sizeof(expected);
+   uint8_t buffer[64];
+   size_t len = sizeof(buffer);
+
+   WHEN("A status is adapted")
+   {
+     int16_t codes[] = { 1, 2, 4, 100, -1, -8, -100, -101, -160, -201, -255 };
+     THEN("The template is equal to the encoding of every status") {
+       for (int16_t code : codes) {
+         StatusProvisioningMessage command;
+         command.c.id = ProvisioningMessageId::StatusProvisioningMessageId;
+         command.status = code;
+         expectedLen = sizeof(expected);
+         REQUIRE(encoder.encode((Message*)&command, expected, expectedLen) == MessageEncoder::Status::Complete);
+
+         len = sizeof(buffer);
+         REQUIRE(CBORAdapter::statusToCBOR((StatusMessage)code, buffer, &len));
+         REQUIRE(len == expectedLen);
+         REQUIRE(memcmp(buffer, expected, len) == 0);
+       }
+     }
+   }
+
+   WHEN("A uniqueHardwareId is adapted")
+   {
+     UniqueHardwareIdProvisioningMessage command;
+     command.c.id = ProvisioningMessageId::UniqueHardwareIdProvisioningMessageId;
+     memset(command.uniqueHardwareId, 0x00, 32);
+     command.uniqueHardwareId[31] = 0xCA;
+     REQUIRE(encoder.encode((Message*)&command, expected, expectedLen) == MessageEncoder::Status::Complete);
+
+     THEN("The template is equal to the encoding") {
+       REQUIRE(CBORAdapter::uhwidToCBOR((const byte *)command.uniqueHardwareId, buffer, &len));
+       REQUIRE(len == expectedLen);
+       REQUIRE(memcmp(buffer, expected, len) == 0);
+     }
+   }
+
+   WHEN("A BLE mac address is adapted")
+   {
+     BLEMacAddressProvisioningMessage command;
+     command.c.id = ProvisioningMessageId::BLEMacAddressProvisioningMessageId;
+     memset(command.macAddress, 0xAF, 6);
+     REQUIRE(encoder.encode((Message*)&command, expected, expectedLen) == MessageEncoder::Status::Complete);
+
+     THEN("The template is equal to the encoding") {
+       REQUIRE(CBORAdapter::BLEMacAddressToCBOR(command.macAddress, buffer, &len));
+       REQUIRE(len == expectedLen);
+       REQUIRE(memcmp(buffer, expected, len) == 0);
+     }
+   }
+
+   WHEN("An empty BLE mac address is adapted")
+   {
+     BLEMacAddressProvisioningMessage command;
+     command.c.id = ProvisioningMessageId::BLEMacAddressProvisioningMessageId;
+     memset(command.macAddress, 0x00, 6);
+     REQUIRE(encoder.encode((Message*)&command, expected, expectedLen) == MessageEncoder::Status::Complete);
+
+     THEN("The template is equal to the encoding") {
+       REQUIRE(CBORAdapter::BLEMacAddressToCBOR(command.macAddress, buffer, &len));
+       REQUIRE(len == expectedLen);
+       REQUIRE(memcmp(buffer, expected, len) == 0);
+     }
+   }
+
+   WHEN("The versions are adapted")
+   {
+     const char version[] = "1.6.0";
+     ProvSketchVersionProvisioningMessage sketchCommand;
+     sketchCommand.c.id = ProvisioningMessageId::ProvSketchVersionProvisioningMessageId;
+     sketchCommand.provSketchVersion = version;
+     REQUIRE(encoder.encode((Message*)&sketchCommand, expected, expectedLen) == MessageEncoder::Status::Complete);
+
+     THEN("The template of the provisioning sketch version is equal to the encoding") {
+       REQUIRE(CBORAdapter::provSketchVersionToCBOR(version, buffer, &len));
+       REQUIRE(len == expectedLen);
+       REQUIRE(memcmp(buffer, expected, len) == 0);
+     }
+
+     NetConfigLibVersionProvisioningMessage libCommand;
+     libCommand.c.id = ProvisioningMessageId::NetConfigLibVersProvisioningMessageId;
+     libCommand.netConfigLibVersion = version;
+     expectedLen = sizeof(expected);
+     REQUIRE(encoder.encode((Message*)&libCommand, expected, expectedLen) == MessageEncoder::Status::Complete);
+
+     THEN("The template of the library version is equal to the encoding") {
+       REQUIRE(CBORAdapter::netConfigLibVersionToCBOR(version, buffer, &len));
+       REQUIRE(len == expectedLen);
+       REQUIRE(memcmp(buffer, expected, len) == 0);
+     }
+   }
+ }
@@ -0,0 +1,42 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include <Decoder.h>
+
+/******************************************************************************
+   CBOR DECODER INSTANCES
+ ******************************************************************************/
+
+/* The firmware decodes the received messages with ProvisioningMessageDecoder.
+ * The decoders of the CBOR library are registered only in the host build,
+ * where the tests and the benchmarks compare against CBORMessageDecoder.
+ */
+
+TimestampProvisioningMessageDecoder      timestampProvisioningMessageDecoder;
+CommandsProvisioningMessageDecoder       commandsProvisioningMessageDecoder;
+#if defined(BOARD_HAS_WIFI)
+WifiConfigProvisioningMessageDecoder     wifiConfigProvisioningMessageDecoder;
+#endif
+#if defined(BOARD_HAS_LORA)
+LoRaConfigProvisioningMessageDecoder     loRaConfigProvisioningMessageDecoder;
+#endif
+#if defined(BOARD_HAS_CATM1_NBIOT)
+CATM1ConfigProvisioningMessageDecoder    cATM1ConfigProvisioningMessageDecoder;
+#endif
+#if defined(BOARD_HAS_ETHERNET)
+EthernetConfigProvisioningMessageDecoder ethernetConfigProvisioningMessageDecoder;
+#endif
+#if defined(BOARD_HAS_CELLULAR)
+CellularConfigProvisioningMessageDecoder cellularConfigProvisioningMessageDecoder;
+#endif
+#if defined(BOARD_HAS_NB)
+NBIOTConfigProvisioningMessageDecoder    nbiotConfigProvisioningMessageDecoder;
+#endif
+#if defined(BOARD_HAS_GSM)
+GSMConfigProvisioningMessageDecoder      gsmConfigProvisioningMessageDecoder;
+#endif
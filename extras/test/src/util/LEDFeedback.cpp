@@ -0,0 +1,32 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include "utility/LEDFeedback.h"
+
+/******************************************************************************
+   LED FEEDBACK STUB
+ ******************************************************************************/
+
+/* The host build has no LEDs, the feedback requested by the agents and by
+ * the AgentsManager is ignored.
+ */
+
+LEDFeedbackClass &LEDFeedbackClass::getInstance()
+{
+  static LEDFeedbackClass instance;
+  return instance;
+}
+
+void LEDFeedbackClass::begin() { }
+void LEDFeedbackClass::setMode(LEDFeedbackMode mode) { _mode = mode; }
+void LEDFeedbackClass::stop() { stopped = true; }
+void LEDFeedbackClass::restart() { stopped = false; }
+void LEDFeedbackClass::update() { }
+void LEDFeedbackClass::turnON() { }
+void LEDFeedbackClass::turnOFF() { }
+void LEDFeedbackClass::configurePeerConnectedMode() { }
@@ -0,0 +1,430 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include <string.h>
+#include "LoopbackAgent.h"
+#include "configuratorAgents/agents/boardConfigurationProtocol/PacketCRC.h"
+
+/******************************************************************************
+   LOOPBACK PIPE
+ ******************************************************************************/
+
+LoopbackPipe::LoopbackPipe(size_t mtu, uint32_t latencyMs, uint8_t lossPercent, uint8_t corruptionPercent)
+: _head{0}
+, _count{0}
+, _seed{1}
+, _writtenUnits{0}
+, _dropUnit{0}
+, _lostUnits{0}
+, _corruptedUnits{0}
+{
+  configure(mtu, latencyMs, lossPercent, corruptionPercent);
+}
+
+void LoopbackPipe::configure(size_t mtu, uint32_t latencyMs, uint8_t lossPercent, uint8_t corruptionPercent)
+{
+  _mtu = mtu;
+  _latencyMs = latencyMs;
+  _lossPercent = lossPercent;
+  _corruptionPercent = corruptionPercent;
+}
+
+void LoopbackPipe::setSeed(uint32_t seed)
+{
+  _seed = seed != 0 ? seed : 1;
+}
+
+void LoopbackPipe::dropUnit(size_t n)
+{
+  _dropUnit = _writtenUnits + n;
+}
+
+size_t LoopbackPipe::write(const uint8_t *data, size_t len)
+{
+  size_t unitLen = len < _mtu ? len : _mtu;
+  if (unitLen > LOOPBACK_PIPE_SIZE - _count) {
+    unitLen = LOOPBACK_PIPE_SIZE - _count;
+  }
+  if (unitLen == 0) {
+    return 0;
+  }
+
+  _writtenUnits++;
+  if (nextRandom() % 100 < _lossPercent || _writtenUnits == _dropUnit) {
+    /* The sender sees the unit as transmitted */
+    _lostUnits++;
+    return unitLen;
+  }
+
+  size_t corruptedIdx = unitLen;
+  if (nextRandom() % 100 < _corruptionPercent) {
+    corruptedIdx = nextRandom() % unitLen;
+    _corruptedUnits++;
+  }
+
+  unsigned long deliveryTs = millis() + _latencyMs;
+  for (size_t i = 0; i < unitLen; i++) {
+    size_t idx = (_head + _count) % LOOPBACK_PIPE_SIZE;
+    _buffer[idx] = i == corruptedIdx ? data[i] ^ 0xff : data[i];
+    _deliveryTs[idx] = deliveryTs;
+    _count++;
+  }
+  return unitLen;
+}
+
+size_t LoopbackPipe::available()
+{
+  size_t n = 0;
+  while (n < _count && (long)(millis() - _deliveryTs[(_head + n) % LOOPBACK_PIPE_SIZE]) >= 0) {
+    n++;
+  }
+  return n;
+}
+
+size_t LoopbackPipe::read(uint8_t *data, size_t len)
+{
+  size_t n = available();
+  if (len > n) {
+    len = n;
+  }
+  for (size_t i = 0; i < len; i++) {
+    data[i] = _buffer[_head];
+    _head = (_head + 1) % LOOPBACK_PIPE_SIZE;
+    _count--;
+  }
+  return len;
+}
+
+void LoopbackPipe::clear()
+{
+  _head = 0;
+  _count = 0;
+}
+
+uint32_t LoopbackPipe::nextRandom()
+{
+  /* xorshift32, deterministic for a given seed */
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  return _seed;
+}
+
+/******************************************************************************
+   LOOPBACK AGENT
+ ******************************************************************************/
+
+LoopbackAgent::LoopbackAgent(LoopbackPipe &rx, LoopbackPipe &tx, AgentTypes type)
+: _rx(rx)
+, _tx(tx)
+, _type{type}
+, _state{AgentConfiguratorStates::END}
+, _disconnectRequest{false}
+, _disconnecting{false}
+, _disconnectStartTs{0}
+{
+}
+
+ConfiguratorAgent::AgentConfiguratorStates LoopbackAgent::begin()
+{
+  if (_state == AgentConfiguratorStates::END) {
+    _state = AgentConfiguratorStates::INIT;
+  }
+  return _state;
+}
+
+ConfiguratorAgent::AgentConfiguratorStates LoopbackAgent::end()
+{
+  if (_state != AgentConfiguratorStates::END) {
+    if (isPeerConnected()) {
+      disconnectPeer();
+    }
+    if (_disconnecting) {
+      drainOutput(LOOPBACK_DISCONNECT_TIMEOUT_MS);
+    }
+    _disconnecting = false;
+    clear();
+    _state = AgentConfiguratorStates::END;
+  }
+  return _state;
+}
+
+ConfiguratorAgent::AgentConfiguratorStates LoopbackAgent::update()
+{
+  if (_disconnecting) {
+    handleDisconnecting();
+  }
+
+  switch (_state) {
+    case AgentConfiguratorStates::INIT:           _state = handleInit         (); break;
+    case AgentConfiguratorStates::RECEIVED_DATA:
+    case AgentConfiguratorStates::PEER_CONNECTED: _state = handlePeerConnected(); break;
+    default:                                                                      break;
+  }
+
+  if (_disconnectRequest) {
+    _disconnectRequest = false;
+    clear();
+    _state = AgentConfiguratorStates::INIT;
+  }
+
+  checkOutputPacketValidity();
+
+  return _state;
+}
+
+void LoopbackAgent::disconnectPeer()
+{
+  uint8_t data = (uint8_t)PacketManager::TransmissionControlMessage::DISCONNECT;
+  sendData(PacketManager::MessageType::TRANSMISSION_CONTROL, &data, sizeof(data));
+  clearInput();
+  _disconnecting = true;
+  _disconnectStartTs = millis();
+  _state = AgentConfiguratorStates::INIT;
+}
+
+void LoopbackAgent::handleDisconnecting()
+{
+  if (transmitStream() == TransmissionResult::COMPLETED || millis() - _disconnectStartTs > LOOPBACK_DISCONNECT_TIMEOUT_MS) {
+    _disconnecting = false;
+    clear();
+  }
+}
+
+bool LoopbackAgent::receivedMsgAvailable()
+{
+  return BoardConfigurationProtocol::msgAvailable();
+}
+
+bool LoopbackAgent::getReceivedMsg(ProvisioningInputMessage &msg)
+{
+  bool res = BoardConfigurationProtocol::getMsg(msg);
+  if (receivedMsgAvailable() == false) {
+    _state = AgentConfiguratorStates::PEER_CONNECTED;
+  }
+  return res;
+}
+
+bool LoopbackAgent::sendMsg(ProvisioningOutputMessage &msg)
+{
+  return BoardConfigurationProtocol::sendMsg(msg);
+}
+
+bool LoopbackAgent::isSendingMsg()
+{
+  return BoardConfigurationProtocol::pendingOutput();
+}
+
+bool LoopbackAgent::isPeerConnected()
+{
+  return _state == AgentConfiguratorStates::PEER_CONNECTED || _state == AgentConfiguratorStates::RECEIVED_DATA;
+}
+
+ConfiguratorAgent::AgentConfiguratorStates LoopbackAgent::handleInit()
+{
+  AgentConfiguratorStates nextState = _state;
+  uint8_t chunk[BCP_RECEIVE_CHUNK_SIZE];
+  size_t chunkLen = 0;
+
+  while ((chunkLen = readBytes(chunk, sizeof(chunk))) > 0) {
+    size_t offset = 0;
+    while (offset < chunkLen || PacketManager::PacketReceiver::getInstance().hasPendingBytes(_packet)) {
+      size_t consumed = 0;
+      PacketManager::ReceivingState res = PacketManager::PacketReceiver::getInstance().handleReceivedChunk(_packet, &chunk[offset], chunkLen - offset, consumed);
+      offset += consumed;
+      if (res == PacketManager::ReceivingState::RECEIVED) {
+        if (_packet.Type == PacketManager::MessageType::TRANSMISSION_CONTROL &&
+            _packet.Payload.len() == 1 && _packet.Payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::CONNECT) {
+          if (_disconnecting) {
+            _disconnecting = false;
+            clear();
+          }
+          nextState = AgentConfiguratorStates::PEER_CONNECTED;
+        }
+        PacketManager::PacketReceiver::getInstance().clear(_packet);
+      }
+    }
+  }
+
+  return nextState;
+}
+
+ConfiguratorAgent::AgentConfiguratorStates LoopbackAgent::handlePeerConnected()
+{
+  AgentConfiguratorStates nextState = _state;
+
+  switch (sendAndReceive()) {
+    case TransmissionResult::PEER_NOT_AVAILABLE:
+      clear();
+      nextState = AgentConfiguratorStates::INIT;
+      break;
+    case TransmissionResult::DATA_RECEIVED:
+      nextState = AgentConfiguratorStates::RECEIVED_DATA;
+      break;
+    default:
+      break;
+  }
+
+  return nextState;
+}
+
+bool LoopbackAgent::received()
+{
+  return _rx.available() > 0;
+}
+
+size_t LoopbackAgent::available()
+{
+  return _rx.available();
+}
+
+uint8_t LoopbackAgent::read()
+{
+  uint8_t byte = 0;
+  _rx.read(&byte, sizeof(byte));
+  return byte;
+}
+
+size_t LoopbackAgent::readBytes(uint8_t *data, size_t len)
+{
+  return _rx.read(data, len);
+}
+
+int LoopbackAgent::write(const uint8_t *data, size_t len)
+{
+  return _tx.write(data, len);
+}
+
+void LoopbackAgent::handleDisconnectRequest()
+{
+  _disconnectRequest = true;
+}
+
+void LoopbackAgent::clearInputBuffer()
+{
+  uint8_t byte;
+  while (_rx.read(&byte, sizeof(byte)) > 0) {
+  }
+}
+
+/******************************************************************************
+   LOOPBACK PEER
+ ******************************************************************************/
+
+LoopbackPeer::LoopbackPeer(LoopbackPipe &rx, LoopbackPipe &tx)
+: _rx(rx)
+, _tx(tx)
+{
+}
+
+bool LoopbackPeer::sendPacket(PacketManager::MessageType type, const uint8_t *data, size_t len)
+{
+  OutputPacketBuffer packet;
+  if (!PacketManager::createPacket(packet, type, data, len)) {
+    return false;
+  }
+
+  while (packet.hasBytesToSend()) {
+    size_t written = _tx.write(packet.get_ptrAt(packet.bytesSent()), packet.bytesToSend());
+    if (written == 0) {
+      return false;
+    }
+    packet.incrementBytesSent(written);
+  }
+  return true;
+}
+
+bool LoopbackPeer::sendControl(PacketManager::TransmissionControlMessage msg)
+{
+  uint8_t data = (uint8_t)msg;
+  return sendPacket(PacketManager::MessageType::TRANSMISSION_CONTROL, &data, sizeof(data));
+}
+
+bool LoopbackPeer::sendControl(PacketManager::TransmissionControlMessage msg, uint8_t seq)
+{
+  uint8_t data[] = {(uint8_t)msg, seq};
+  return sendPacket(PacketManager::MessageType::TRANSMISSION_CONTROL, data, sizeof(data));
+}
+
+bool LoopbackPeer::sendSequencedPacket(uint8_t seq, const uint8_t *data, size_t len)
+{
+  std::vector<uint8_t> payload(1, seq);
+  payload.insert(payload.end(), data, data + len);
+  return sendPacket(PacketManager::MessageType::SEQUENCED_DATA, payload.data(), payload.size());
+}
+
+bool LoopbackPeer::sendCommand(RemoteCommands cmd)
+{
+  uint8_t data[8];
+  size_t len = encodeCommand(cmd, data);
+  return sendPacket(PacketManager::MessageType::DATA, data, len);
+}
+
+bool LoopbackPeer::sendCommand(RemoteCommands cmd, uint8_t seq)
+{
+  uint8_t data[8];
+  size_t len = encodeCommand(cmd, data);
+  return sendSequencedPacket(seq, data, len);
+}
+
+bool LoopbackPeer::receivePacket(PacketManager::MessageType &type, std::vector<uint8_t> &payload)
+{
+  uint8_t chunk[64];
+  size_t chunkLen = 0;
+  while ((chunkLen = _rx.read(chunk, sizeof(chunk))) > 0) {
+    _rxBuffer.insert(_rxBuffer.end(), chunk, chunk + chunkLen);
+  }
+
+  while (_rxBuffer.size() >= 5) {
+    if (_rxBuffer[0] != 0x55 || _rxBuffer[1] != 0xaa) {
+      _rxBuffer.erase(_rxBuffer.begin());
+      continue;
+    }
+
+    size_t packetLen = ((size_t)_rxBuffer[3] << 8) | _rxBuffer[4];
+    size_t totalLen = 5 + packetLen + 2;
+    if (packetLen < 2) {
+      _rxBuffer.erase(_rxBuffer.begin());
+      continue;
+    }
+    if (_rxBuffer.size() < totalLen) {
+      return false;
+    }
+
+    size_t payloadLen = packetLen - 2;
+    uint16_t crc = ((uint16_t)_rxBuffer[5 + payloadLen] << 8) | _rxBuffer[5 + payloadLen + 1];
+    bool valid = crc == PacketCRC::calculate(&_rxBuffer[5], payloadLen) &&
+                 _rxBuffer[totalLen - 2] == 0xaa && _rxBuffer[totalLen - 1] == 0x55;
+    if (!valid) {
+      _rxBuffer.erase(_rxBuffer.begin());
+      continue;
+    }
+
+    type = (PacketManager::MessageType)_rxBuffer[2];
+    payload.assign(_rxBuffer.begin() + 5, _rxBuffer.begin() + 5 + payloadLen);
+    _rxBuffer.erase(_rxBuffer.begin(), _rxBuffer.begin() + totalLen);
+    return true;
+  }
+
+  return false;
+}
+
+size_t LoopbackPeer::encodeCommand(RemoteCommands cmd, uint8_t *data)
+{
+  /* tag(0x012003) array(1) unsigned(cmd) */
+  const uint8_t header[] = {0xda, 0x00, 0x01, 0x20, 0x03, 0x81};
+  size_t len = sizeof(header);
+  memcpy(data, header, len);
+  if ((int)cmd < 24) {
+    data[len++] = (uint8_t)cmd;
+  } else {
+    data[len++] = 0x18;
+    data[len++] = (uint8_t)cmd;
+  }
+  return len;
+}
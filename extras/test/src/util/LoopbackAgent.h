@@ -0,0 +1,137 @@
+/*
+   Copyright (c) 2024 Arduino.  All rights reserved.
+*/
+
+#ifndef TEST_LOOPBACK_AGENT_H_
+#define TEST_LOOPBACK_AGENT_H_
+
+/******************************************************************************
+   INCLUDE
+ ******************************************************************************/
+
+#include <vector>
+#include <Arduino.h>
+#include "configuratorAgents/agents/ConfiguratorAgent.h"
+#include "configuratorAgents/agents/boardConfigurationProtocol/BoardConfigurationProtocol.h"
+#include "configuratorAgents/agents/boardConfigurationProtocol/cbor/CBORInstances.h"
+
+/******************************************************************************
+   DEFINES
+ ******************************************************************************/
+
+#define LOOPBACK_PIPE_SIZE 2048
+#define LOOPBACK_DISCONNECT_TIMEOUT_MS 500
+
+/******************************************************************************
+   CLASS DECLARATION
+ ******************************************************************************/
+
+/* One direction of an in memory link. Every write() is a transmission unit:
+ * at most mtu bytes are accepted, they become readable latencyMs after the
+ * write, the whole unit is dropped with probability lossPercent and one of
+ * its bytes is altered with probability corruptionPercent.
+ * dropUnit(n) drops the n-th unit written after the call.
+ */
+class LoopbackPipe
+{
+public:
+  LoopbackPipe(size_t mtu = LOOPBACK_PIPE_SIZE, uint32_t latencyMs = 0, uint8_t lossPercent = 0, uint8_t corruptionPercent = 0);
+
+  void configure(size_t mtu, uint32_t latencyMs, uint8_t lossPercent, uint8_t corruptionPercent);
+  void setSeed(uint32_t seed);
+  void dropUnit(size_t n);
+  size_t write(const uint8_t *data, size_t len);
+  size_t available();
+  size_t read(uint8_t *data, size_t len);
+  void clear();
+
+  size_t writtenUnits() { return _writtenUnits; }
+  size_t lostUnits() { return _lostUnits; }
+  size_t corruptedUnits() { return _corruptedUnits; }
+
+private:
+  uint8_t _buffer[LOOPBACK_PIPE_SIZE];
+  unsigned long _deliveryTs[LOOPBACK_PIPE_SIZE];
+  size_t _head;
+  size_t _count;
+  size_t _mtu;
+  uint32_t _latencyMs;
+  uint8_t _lossPercent;
+  uint8_t _corruptionPercent;
+  uint32_t _seed;
+  size_t _writtenUnits;
+  size_t _dropUnit;
+  size_t _lostUnits;
+  size_t _corruptedUnits;
+
+  uint32_t nextRandom();
+};
+
+/* Agent running the BoardConfigurationProtocol over a pair of LoopbackPipe.
+ * It behaves like the SerialAgent: it waits for the CONNECT transmission
+ * control message of the peer and then exchanges the protocol packets.
+ */
+class LoopbackAgent : public ConfiguratorAgent, private BoardConfigurationProtocol
+{
+public:
+  LoopbackAgent(LoopbackPipe &rx, LoopbackPipe &tx, AgentTypes type = AgentTypes::USB_SERIAL);
+
+  AgentConfiguratorStates begin() override;
+  AgentConfiguratorStates end() override;
+  AgentConfiguratorStates update() override;
+  void disconnectPeer() override;
+  bool receivedMsgAvailable() override;
+  bool getReceivedMsg(ProvisioningInputMessage &msg) override;
+  bool sendMsg(ProvisioningOutputMessage &msg) override;
+  bool isSendingMsg() override;
+  bool isPeerConnected() override;
+  AgentTypes getAgentType() override { return _type; }
+
+private:
+  LoopbackPipe &_rx;
+  LoopbackPipe &_tx;
+  AgentTypes _type;
+  AgentConfiguratorStates _state;
+  bool _disconnectRequest;
+  bool _disconnecting;
+  unsigned long _disconnectStartTs;
+  PacketManager::Packet_t _packet;
+
+  AgentConfiguratorStates handleInit();
+  AgentConfiguratorStates handlePeerConnected();
+  void handleDisconnecting();
+
+  bool received() override;
+  size_t available() override;
+  uint8_t read() override;
+  size_t readBytes(uint8_t *data, size_t len) override;
+  int write(const uint8_t *data, size_t len) override;
+  void handleDisconnectRequest() override;
+  void clearInputBuffer() override;
+};
+
+/* The user device side of the link: it sends packets to the agent splitting
+ * them in units of the pipe MTU and extracts the valid packets sent by the agent.
+ */
+class LoopbackPeer
+{
+public:
+  LoopbackPeer(LoopbackPipe &rx, LoopbackPipe &tx);
+
+  bool sendPacket(PacketManager::MessageType type, const uint8_t *data, size_t len);
+  bool sendControl(PacketManager::TransmissionControlMessage msg);
+  bool sendControl(PacketManager::TransmissionControlMessage msg, uint8_t seq);
+  bool sendSequencedPacket(uint8_t seq, const uint8_t *data, size_t len);
+  bool sendCommand(RemoteCommands cmd);
+  bool sendCommand(RemoteCommands cmd, uint8_t seq);
+  bool receivePacket(PacketManager::MessageType &type, std::vector<uint8_t> &payload);
+
+private:
+  LoopbackPipe &_rx;
+  LoopbackPipe &_tx;
+  std::vector<uint8_t> _rxBuffer;
+
+  size_t encodeCommand(RemoteCommands cmd, uint8_t *data);
+};
+
+#endif /* TEST_LOOPBACK_AGENT_H_ */
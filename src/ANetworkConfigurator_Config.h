@@ -138,6 +138,103 @@
 #define BCP_DEBUG_PACKET 0
 #endif
 
+// Size of the stack buffer used for reading the received bytes in chunks
+#ifndef BCP_RECEIVE_CHUNK_SIZE
+#define BCP_RECEIVE_CHUNK_SIZE 64
+#endif
+
+// Maximum number of WiFi networks sent to the peer, the strongest networks of the scan are kept. Max 254
+#ifndef MAX_WIFI_NETWORKS
+#define MAX_WIFI_NETWORKS 20
+#endif
+
+// Size of the packet of the list of the discovered WiFi networks.
+// Each network takes up to 37 bytes: 32 of SSID, 1 of string header and up to 4 of RSSI
+#define BCP_WIFI_LIST_FRAME_SIZE (MAX_WIFI_NETWORKS * 37 + 29)
+// Size of the biggest fixed shape packet sent: the JWT, 278 bytes of CBOR, 1 of sequence number and 9 of packet framing
+#define BCP_JWT_FRAME_SIZE 288
+// Size of the biggest network settings packet received: the CATM1 settings, 275 bytes of CBOR, 1 of sequence number and 9 of packet framing
+#define BCP_SETTINGS_FRAME_SIZE 285
+#define BCP_MAX_SIZE(a, b) ((a) > (b) ? (a) : (b))
+
+// Size of each static buffer, it must fit the biggest packet exchanged in both directions
+#ifndef BCP_PACKET_POOL_SLOT_SIZE
+#define BCP_PACKET_POOL_SLOT_SIZE BCP_MAX_SIZE(BCP_WIFI_LIST_FRAME_SIZE, BCP_MAX_SIZE(BCP_JWT_FRAME_SIZE, BCP_SETTINGS_FRAME_SIZE))
+#endif
+
+// Maximum size of a received packet, packets declaring a bigger length are rejected before being buffered
+#ifndef BCP_MAX_FRAME_SIZE
+#define BCP_MAX_FRAME_SIZE BCP_PACKET_POOL_SLOT_SIZE
+#endif
+
+// Maximum number of packets waiting to be sent or acknowledged by the peer.
+// A peer without the selective mode doesn't acknowledge the packets, the oldest one already sent is dropped
+// to make room for a new one. A message is refused only when all the queued packets have bytes still to send
+// or, in selective mode, are waiting for the ACK. The biggest burst queued without updating the agent is
+// the reply to GET_ID: uhwid, JWT and provisioning public key, the depth fits it with the BCP_SEND_WINDOW
+// packets in flight and a control packet
+#ifndef BCP_OUTPUT_QUEUE_DEPTH
+#define BCP_OUTPUT_QUEUE_DEPTH 8
+#endif
+
+// Maximum number of DATA packets in flight waiting for the ACK of a peer that supports the selective mode
+#ifndef BCP_SEND_WINDOW
+#define BCP_SEND_WINDOW 4
+#endif
+
+// Number of framed status packets cached after being sent the first time, up to 25 for caching every status code
+#ifndef BCP_STATUS_FRAME_CACHE_SIZE
+#define BCP_STATUS_FRAME_CACHE_SIZE 8
+#endif
+
+// Maximum number of received messages waiting to be processed
+#ifndef BCP_INPUT_QUEUE_DEPTH
+#define BCP_INPUT_QUEUE_DEPTH 4
+#endif
+
+// Number of agents exchanging packets at the same time, only the agent connected to the peer transmits and receives
+#ifndef BCP_ACTIVE_AGENTS
+#define BCP_ACTIVE_AGENTS 1
+#endif
+
+/* The packet pool is static RAM reserved also while the configurator is idle. With the defaults, 20 WiFi networks
+ * and a single active agent, it takes 4 big buffers of 769 bytes and 16 small buffers of 64 bytes: 4100 bytes.
+ * Every agent also holds 16 PacketBuffer objects of about 50 bytes for the queues, about 800 bytes on a 32 bit board.
+ * Reduce MAX_WIFI_NETWORKS, BCP_SEND_WINDOW and the queue depths on the boards short of RAM
+ */
+
+// Number of static buffers reserved for the big packets: the list of the WiFi networks, the JWT and the network settings.
+// Each active agent holds at most the list and the JWT waiting to be sent or acknowledged, up to BCP_SEND_WINDOW of them,
+// a received network settings message waiting to be processed and the packet being received
+#ifndef BCP_PACKET_POOL_SLOTS
+#define BCP_PACKET_POOL_SLOTS (((BCP_SEND_WINDOW < 2 ? BCP_SEND_WINDOW : 2) + 2) * BCP_ACTIVE_AGENTS)
+#endif
+
+// Size of the static buffers reserved for the small packets that don't fit in the PacketBuffer inline storage:
+// uhwid, BLE MAC address, versions and transmission control packets
+#ifndef BCP_PACKET_POOL_SMALL_SLOT_SIZE
+#define BCP_PACKET_POOL_SMALL_SLOT_SIZE 64
+#endif
+
+// Number of static buffers for the small packets, every queued packet, the BCP_SEND_WINDOW - 1 packets received
+// after a missing one and the one being received can be a small one
+#ifndef BCP_PACKET_POOL_SMALL_SLOTS
+#define BCP_PACKET_POOL_SMALL_SLOTS ((BCP_OUTPUT_QUEUE_DEPTH + BCP_INPUT_QUEUE_DEPTH + BCP_SEND_WINDOW) * BCP_ACTIVE_AGENTS)
+#endif
+
+// Number of bytes sent with a single BLE notification or indication, it's the size of the output characteristic.
+// The BLE stack doesn't report the ATT MTU negotiated with the peer and cuts silently the bytes exceeding ATT MTU - 3,
+// so it must not exceed the MTU of any peer: 64 bytes is the size used by the Arduino provisioning apps,
+// 20 bytes fits the default ATT MTU of 23 bytes
+#ifndef BLE_AGENT_MAX_FRAGMENT_SIZE
+#define BLE_AGENT_MAX_FRAGMENT_SIZE 64
+#endif
+
+// Minimum RSSI variation in dBm of an already sent WiFi network to be reported by a network options update
+#ifndef NETWORK_OPTIONS_UPDATE_RSSI_THRESHOLD
+#define NETWORK_OPTIONS_UPDATE_RSSI_THRESHOLD 5
+#endif
+
 // Set to 1 for logging newtwork configurations secrets 
 // Be careful the secrets will be printed in the serial monitor in clear text
 #define DEBUG_NETWORK_CREDENTIALS 0
@@ -10,6 +10,7 @@
 #include "Arduino_NetworkConfigurator.h"
 
 #include <Arduino_DebugUtils.h>
+#include <utility>
 #include "ConnectionHandlerDefinitions.h"
 #include "configuratorAgents/MessagesDefinitions.h"
 
@@ -20,6 +21,7 @@
 #define NC_CONNECTION_RETRY_TIMER_ms 120000
 #define NC_CONNECTION_TIMEOUT_ms 15000
 #define NC_UPDATE_NETWORK_OPTIONS_TIMER_ms 120000
+#define NC_DISCONNECTION_TIMEOUT_ms 5000
 
 constexpr char *STORAGE_KEY{ "NETWORK_CONFIGS" };
 constexpr char *START_BLE_AT_STARTUP_KEY{ "START_BLE" };
@@ -34,10 +36,14 @@ NetworkConfiguratorClass::NetworkConfiguratorClass(ConnectionHandler &connection
     _connectionHandler{ &connectionHandler },
     _connectionHandlerIstantiated{ false },
     _configInProgress{ false },
+    _disconnecting{ false },
+    _stateAfterDisconnection{ NetworkConfiguratorStates::WAITING_FOR_CONFIG },
     _kvstore{ nullptr },
+    _scanState{ ScanStates::NONE },
     _connectionTimeout{ NC_CONNECTION_TIMEOUT_ms, NC_CONNECTION_TIMEOUT_ms },
     _connectionRetryTimer{ NC_CONNECTION_RETRY_TIMER_ms, NC_CONNECTION_RETRY_TIMER_ms },
-    _optionUpdateTimer{ NC_UPDATE_NETWORK_OPTIONS_TIMER_ms, NC_UPDATE_NETWORK_OPTIONS_TIMER_ms } {
+    _optionUpdateTimer{ NC_UPDATE_NETWORK_OPTIONS_TIMER_ms, NC_UPDATE_NETWORK_OPTIONS_TIMER_ms },
+    _disconnectionTimeout{ NC_DISCONNECTION_TIMEOUT_ms, NC_DISCONNECTION_TIMEOUT_ms } {
       _receivedEvent = NetworkConfiguratorEvents::NONE;
       _optionUpdateTimer.begin(NC_UPDATE_NETWORK_OPTIONS_TIMER_ms); //initialize the timer before calling begin
       _agentsManager = &AgentsManagerClass::getInstance();
@@ -50,7 +56,8 @@ bool NetworkConfiguratorClass::begin() {
     return true;
   }
 
-  _state = NetworkConfiguratorStates::READ_STORED_CONFIG;
+  // A disconnection started while the configurator was stopped is completed before reading the storage
+  _state = _disconnecting ? NetworkConfiguratorStates::DISCONNECTING : NetworkConfiguratorStates::READ_STORED_CONFIG;
 
   _connectionHandler->enableCheckInternetAvailability(true);
 
@@ -75,7 +82,7 @@ bool NetworkConfiguratorClass::begin() {
   // Register callbacks to agentsManager
   _agentsManager->addRequestHandler(RequestType::CONNECT, connectReqHandler);
 
-  _agentsManager->addReturnNetworkSettingsCallback(setNetworkSettingsHandler);
+  _agentsManager->addReturnNetworkSettingsCallback(setNetworkSettingsHandler, &_networkSetting);
 
   _agentsManager->addRequestHandler(RequestType::GET_NETCONFIG_LIB_VERSION, getNetConfLibVersionHandler);
 
@@ -102,6 +109,7 @@ NetworkConfiguratorStates NetworkConfiguratorClass::update() {
     case NetworkConfiguratorStates::CONNECTING:         nextState = handleConnecting     (); break;
     case NetworkConfiguratorStates::CONFIGURED:         nextState = handleConfigured     (); break;
     case NetworkConfiguratorStates::UPDATING_CONFIG:    nextState = handleUpdatingConfig (); break;
+    case NetworkConfiguratorStates::DISCONNECTING:      nextState = handleDisconnecting  (); break;
     case NetworkConfiguratorStates::ERROR:              nextState = handleErrorState     (); break;
     case NetworkConfiguratorStates::END:                                                     break;
   }
@@ -110,9 +118,27 @@ NetworkConfiguratorStates NetworkConfiguratorClass::update() {
     if(nextState == NetworkConfiguratorStates::CONNECTING){
       setConnectionTimeoutTimer();
     }
+    // A scan requested by the previous state is cancelled, the one requested while changing state is kept
+    if (_scanState == ScanStates::WAITING_STATUS) {
+      _scanState = ScanStates::NONE;
+    }
     _state = nextState;
   }
 
+  /* The scan blocks the WiFi driver, it's performed only after the agents have written
+   * the SCANNING status to the peer
+   */
+  if (_scanState != ScanStates::NONE) {
+    if (!isScanAllowed()) {
+      _scanState = ScanStates::NONE;
+    } else if (_agentsManager->isSendingMsg()) {
+      _scanState = ScanStates::WAITING_STATUS;
+    } else {
+      _scanState = ScanStates::NONE;
+      sendNetworkOptions();
+    }
+  }
+
   /* Reconfiguration procedure:
    * - Arduino Opta: press and hold the user button (BTN_USER) until the led (LED_USER) turns off
    * - Arduino MKR WiFi 1010: short the pin 7 to GND until the led turns off
@@ -135,12 +161,12 @@ bool NetworkConfiguratorClass::resetStoredConfiguration() {
 
   memset(&_networkSetting, 0x00, sizeof(models::NetworkSetting));
   if(_connectionHandlerIstantiated) {
-    disconnectFromNetwork();
+    startDisconnection(_state == NetworkConfiguratorStates::END ? NetworkConfiguratorStates::READ_STORED_CONFIG : NetworkConfiguratorStates::WAITING_FOR_CONFIG);
     _connectionHandlerIstantiated = false;
   }
 
   if(_state != NetworkConfiguratorStates::END) {
-    _state = NetworkConfiguratorStates::WAITING_FOR_CONFIG;
+    _state = _disconnecting ? NetworkConfiguratorStates::DISCONNECTING : NetworkConfiguratorStates::WAITING_FOR_CONFIG;
   }
 
   if(_kvstore == nullptr){
@@ -171,32 +197,19 @@ bool NetworkConfiguratorClass::end() {
   _agentsManager->removeRequestHandler(RequestType::SCAN);
   _agentsManager->removeRequestHandler(RequestType::CONNECT);
   _agentsManager->removeRequestHandler(RequestType::GET_WIFI_FW_VERSION);
+  if (_disconnecting) {
+    // The new network settings are applied again after a restart
+    _stateAfterDisconnection = NetworkConfiguratorStates::READ_STORED_CONFIG;
+  }
   _state = NetworkConfiguratorStates::END;
   return _agentsManager->end();
 }
 
 bool NetworkConfiguratorClass::scanNetworkOptions() {
-// If board has Wifi scan for networks
 #ifdef BOARD_HAS_WIFI
   sendStatus(StatusMessage::SCANNING);  //Notify before scan
-
-  WiFiOption wifiOptObj;
-
-  if (!scanWiFiNetworks(wifiOptObj)) {
-    sendStatus(StatusMessage::HW_ERROR_CONN_MODULE);
-    return false;
-  }
-
-  NetworkOptions netOption = { NetworkOptionsClass::WIFI, wifiOptObj };
-#else // Send an empty network options message
-  NetworkOptions netOption = { NetworkOptionsClass::NONE };
 #endif
-  ProvisioningOutputMessage netOptionMsg = { MessageOutputType::NETWORK_OPTIONS };
-  netOptionMsg.m.netOptions = &netOption;
-  _agentsManager->sendMsg(netOptionMsg);
-
-  _optionUpdateTimer.reload();
-  return true;
+  return sendNetworkOptions();
 }
 
 void NetworkConfiguratorClass::setStorage(KVStore &kvstore) {
@@ -253,53 +266,202 @@ NetworkConfiguratorClass::ConnectionResult NetworkConfiguratorClass::connectToNe
   return res;
 }
 
-NetworkConfiguratorClass::ConnectionResult NetworkConfiguratorClass::disconnectFromNetwork() {
+void NetworkConfiguratorClass::startDisconnection(NetworkConfiguratorStates nextState) {
+  // The ConnectionHandler is polled by handleDisconnecting() until it reaches the CLOSED state
   _connectionHandler->disconnect();
-  uint32_t startDisconnection = millis();
-  NetworkConnectionState s;
-  do {
-    s = _connectionHandler->check();
-  } while (s != NetworkConnectionState::CLOSED && millis() - startDisconnection < 5000);
+  _disconnectionTimeout.begin(NC_DISCONNECTION_TIMEOUT_ms);
+  _disconnectionTimeout.reload();
+  _stateAfterDisconnection = nextState;
+  _disconnecting = true;
+}
 
-  if (s != NetworkConnectionState::CLOSED) {
-    return ConnectionResult::FAILED;
+void NetworkConfiguratorClass::requestScan() {
+  if (_scanState == ScanStates::NONE) {
+#ifdef BOARD_HAS_WIFI
+    sendStatus(StatusMessage::SCANNING);  //Notify before scan
+#endif
   }
-  // Reset the connection handler to INIT state
-  _connectionHandler->connect();
+  _scanState = ScanStates::REQUESTED;
+}
 
-  return ConnectionResult::SUCCESS;
+// The scan is performed only by the states waiting for a configuration
+bool NetworkConfiguratorClass::isScanAllowed() {
+  switch (_state) {
+    case NetworkConfiguratorStates::READ_STORED_CONFIG:
+#if ZERO_TOUCH_ENABLED
+    case NetworkConfiguratorStates::ZERO_TOUCH_CONFIG:
+#endif
+    case NetworkConfiguratorStates::WAITING_FOR_CONFIG:
+    case NetworkConfiguratorStates::UPDATING_CONFIG:
+      return true;
+    default:
+      return false;
+  }
 }
 
+bool NetworkConfiguratorClass::sendNetworkOptions() {
+// If board has Wifi scan for networks
 #ifdef BOARD_HAS_WIFI
-// insert a new WiFi network in the list of discovered networks
-bool NetworkConfiguratorClass::insertWiFiAP(WiFiOption &wifiOptObj, char *ssid, int rssi) {
-  if (wifiOptObj.numDiscoveredWiFiNetworks >= MAX_WIFI_NETWORKS) {
+  WiFiOption wifiOptObj;
+
+  if (!scanWiFiNetworks(wifiOptObj)) {
+    sendStatus(StatusMessage::HW_ERROR_CONN_MODULE);
     return false;
   }
 
-  // check if the network is already in the list and update the RSSI
-  for (uint8_t i = 0; i < wifiOptObj.numDiscoveredWiFiNetworks; i++) {
-    if (wifiOptObj.discoveredWifiNetworks[i].SSID == nullptr) {
+  NetworkOptions netOption = { NetworkOptionsClass::WIFI, wifiOptObj };
+#else // Send an empty network options message
+  NetworkOptions netOption = { NetworkOptionsClass::NONE };
+#endif
+  ProvisioningOutputMessage netOptionMsg = { MessageOutputType::NETWORK_OPTIONS };
+  netOptionMsg.m.netOptions = &netOption;
+  _agentsManager->sendMsg(netOptionMsg);
+
+  _optionUpdateTimer.reload();
+  return true;
+}
+
+#ifdef BOARD_HAS_WIFI
+// FNV-1a hash of the SSID, the length of the SSID is returned in size
+static uint32_t hashSSID(const char *ssid, size_t *size) {
+  uint32_t hash = 2166136261UL;
+  size_t i = 0;
+  for (; ssid[i] != '\0'; i++) {
+    hash ^= (uint8_t)ssid[i];
+    hash *= 16777619UL;
+  }
+  *size = i;
+  return hash;
+}
+
+// Returns the slot of the hash set storing the SSID or the empty slot where it can be inserted
+static unsigned int probeSSIDSlot(const WiFiOption &wifiOptObj, uint32_t hash, const char *ssid) {
+  unsigned int slot = hash % WIFI_SSID_SET_SIZE;
+  while (wifiOptObj.SSIDSet[slot] != 0) {
+    uint8_t idx = wifiOptObj.SSIDSet[slot] - 1;
+    if (wifiOptObj.SSIDHash[idx] == hash && strcmp(wifiOptObj.discoveredWifiNetworks[idx].SSID, ssid) == 0) {
       break;
     }
-    if (strcmp(wifiOptObj.discoveredWifiNetworks[i].SSID, ssid) == 0) {
-      if (wifiOptObj.discoveredWifiNetworks[i].RSSI < rssi) {
-        wifiOptObj.discoveredWifiNetworks[i].RSSI = rssi;
-      }
-      return true;
+    slot = (slot + 1) % WIFI_SSID_SET_SIZE;
+  }
+  return slot;
+}
+
+// Returns the slot of the hash set storing the network at index idx
+static unsigned int findSSIDSlot(const WiFiOption &wifiOptObj, int idx) {
+  unsigned int slot = wifiOptObj.SSIDHash[idx] % WIFI_SSID_SET_SIZE;
+  while (wifiOptObj.SSIDSet[slot] != idx + 1) {
+    slot = (slot + 1) % WIFI_SSID_SET_SIZE;
+  }
+  return slot;
+}
+
+// Empties a slot of the hash set moving back the following entries of the probe sequence
+static void removeSSIDSlot(WiFiOption &wifiOptObj, unsigned int slot) {
+  unsigned int next = (slot + 1) % WIFI_SSID_SET_SIZE;
+  while (wifiOptObj.SSIDSet[next] != 0) {
+    unsigned int home = wifiOptObj.SSIDHash[wifiOptObj.SSIDSet[next] - 1] % WIFI_SSID_SET_SIZE;
+    // The entry can't be moved in the empty slot if its home slot is in the cyclic range (slot, next]
+    bool homeAfterHole = slot <= next ? (slot < home && home <= next) : (slot < home || home <= next);
+    if (!homeAfterHole) {
+      wifiOptObj.SSIDSet[slot] = wifiOptObj.SSIDSet[next];
+      slot = next;
     }
+    next = (next + 1) % WIFI_SSID_SET_SIZE;
   }
+  wifiOptObj.SSIDSet[slot] = 0;
+}
+
+/* The discovered networks are kept in a min-heap ordered by RSSI, the weakest network is the first one.
+ * The hash set is updated every time two networks are swapped
+ */
+static void swapWiFiAP(WiFiOption &wifiOptObj, int i, int j) {
+  unsigned int slotI = findSSIDSlot(wifiOptObj, i);
+  unsigned int slotJ = findSSIDSlot(wifiOptObj, j);
+  std::swap(wifiOptObj.discoveredWifiNetworks[i], wifiOptObj.discoveredWifiNetworks[j]);
+  std::swap(wifiOptObj.SSIDHash[i], wifiOptObj.SSIDHash[j]);
+  wifiOptObj.SSIDSet[slotI] = j + 1;
+  wifiOptObj.SSIDSet[slotJ] = i + 1;
+}
+
+static void siftUpWiFiAP(WiFiOption &wifiOptObj, int i) {
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (wifiOptObj.discoveredWifiNetworks[parent].RSSI <= wifiOptObj.discoveredWifiNetworks[i].RSSI) {
+      return;
+    }
+    swapWiFiAP(wifiOptObj, i, parent);
+    i = parent;
+  }
+}
+
+static void siftDownWiFiAP(WiFiOption &wifiOptObj, int i, int size) {
+  while (true) {
+    int weakest = i;
+    int left = 2 * i + 1;
+    int right = left + 1;
+    if (left < size && wifiOptObj.discoveredWifiNetworks[left].RSSI < wifiOptObj.discoveredWifiNetworks[weakest].RSSI) {
+      weakest = left;
+    }
+    if (right < size && wifiOptObj.discoveredWifiNetworks[right].RSSI < wifiOptObj.discoveredWifiNetworks[weakest].RSSI) {
+      weakest = right;
+    }
+    if (weakest == i) {
+      return;
+    }
+    swapWiFiAP(wifiOptObj, i, weakest);
+    i = weakest;
+  }
+}
+
+// insert a new WiFi network in the list of discovered networks, if the list is full the weakest network is replaced
+bool NetworkConfiguratorClass::insertWiFiAP(WiFiOption &wifiOptObj, char *ssid, int rssi) {
+  size_t ssidSize;
+  uint32_t hash = hashSSID(ssid, &ssidSize);
+  unsigned int slot = probeSSIDSlot(wifiOptObj, hash, ssid);
+
+  // check if the network is already in the list and update the RSSI
+  if (wifiOptObj.SSIDSet[slot] != 0) {
+    uint8_t idx = wifiOptObj.SSIDSet[slot] - 1;
+    if (wifiOptObj.discoveredWifiNetworks[idx].RSSI < rssi) {
+      wifiOptObj.discoveredWifiNetworks[idx].RSSI = rssi;
+      siftDownWiFiAP(wifiOptObj, idx, wifiOptObj.numDiscoveredWiFiNetworks);
+    }
+    return true;
+  }
+
+  int idx = wifiOptObj.numDiscoveredWiFiNetworks;
+  if (idx >= MAX_WIFI_NETWORKS) {
+    if (rssi <= wifiOptObj.discoveredWifiNetworks[0].RSSI) {
+      return false;
+    }
+    // replace the weakest network, the removal can move the slot of the new SSID
+    removeSSIDSlot(wifiOptObj, findSSIDSlot(wifiOptObj, 0));
+    slot = probeSSIDSlot(wifiOptObj, hash, ssid);
+    idx = 0;
+  } else {
+    wifiOptObj.numDiscoveredWiFiNetworks++;
+  }
+
   // add the network to the list
-  wifiOptObj.discoveredWifiNetworks[wifiOptObj.numDiscoveredWiFiNetworks].SSID = ssid;
-  wifiOptObj.discoveredWifiNetworks[wifiOptObj.numDiscoveredWiFiNetworks].SSIDsize = strlen(ssid);
-  wifiOptObj.discoveredWifiNetworks[wifiOptObj.numDiscoveredWiFiNetworks].RSSI = rssi;
-  wifiOptObj.numDiscoveredWiFiNetworks++;
+  wifiOptObj.discoveredWifiNetworks[idx].SSID = ssid;
+  wifiOptObj.discoveredWifiNetworks[idx].SSIDsize = ssidSize;
+  wifiOptObj.discoveredWifiNetworks[idx].RSSI = rssi;
+  wifiOptObj.SSIDHash[idx] = hash;
+  wifiOptObj.SSIDSet[slot] = idx + 1;
+
+  if (idx == 0) {
+    siftDownWiFiAP(wifiOptObj, idx, wifiOptObj.numDiscoveredWiFiNetworks);
+  } else {
+    siftUpWiFiAP(wifiOptObj, idx);
+  }
 
   return true;
 }
 
 bool NetworkConfiguratorClass::scanWiFiNetworks(WiFiOption &wifiOptObj) {
   wifiOptObj.numDiscoveredWiFiNetworks = 0;
+  memset(wifiOptObj.SSIDSet, 0, sizeof(wifiOptObj.SSIDSet));
 
 #if defined(ARDUINO_OPTA)
   if(_getPid_() != OPTA_WIFI_PID) {
@@ -323,11 +485,15 @@ bool NetworkConfiguratorClass::scanWiFiNetworks(WiFiOption &wifiOptObj) {
     return false;
   }
 
-  // insert the networks in the list
-  for (int thisNet = 0; thisNet < numSsid && thisNet < MAX_WIFI_NETWORKS; thisNet++) {
-    if (!insertWiFiAP(wifiOptObj, const_cast<char *>(WiFi.SSID(thisNet)), WiFi.RSSI(thisNet))) {
-      break;
-    }
+  // keep the strongest networks of the scan
+  for (int thisNet = 0; thisNet < numSsid; thisNet++) {
+    insertWiFiAP(wifiOptObj, const_cast<char *>(WiFi.SSID(thisNet)), WiFi.RSSI(thisNet));
+  }
+
+  // sort the networks from the strongest, at each step the weakest one is moved to the end of the list
+  for (int last = wifiOptObj.numDiscoveredWiFiNetworks - 1; last > 0; last--) {
+    swapWiFiAP(wifiOptObj, 0, last);
+    siftDownWiFiAP(wifiOptObj, 0, last);
   }
 
   return true;
@@ -343,7 +509,10 @@ void NetworkConfiguratorClass::connectReqHandler() {
 }
 
 void NetworkConfiguratorClass::setNetworkSettingsHandler(models::NetworkSetting *netSetting) {
-  memcpy(&_networkSetting, netSetting, sizeof(models::NetworkSetting));
+  // The received settings are decoded in place in _networkSetting
+  if (netSetting != &_networkSetting) {
+    memcpy(&_networkSetting, netSetting, sizeof(models::NetworkSetting));
+  }
   printNetworkSettings();
   _receivedEvent = NetworkConfiguratorEvents::NEW_NETWORK_SETTINGS;
 }
@@ -356,17 +525,17 @@ void NetworkConfiguratorClass::getNetConfLibVersionHandler() {
   _receivedEvent = NetworkConfiguratorEvents::GET_NET_CONF_LIB_VERSION;
 }
 
-bool NetworkConfiguratorClass::handleConnectRequest() {
+NetworkConfiguratorClass::ConnectionResult NetworkConfiguratorClass::handleConnectRequest() {
   if (_networkSetting.type == NetworkAdapter::NONE) {
     sendStatus(StatusMessage::PARAMS_NOT_FOUND);
-    return false;
+    return ConnectionResult::FAILED;
   }
 
 #ifdef ARDUINO_OPTA
   if(_networkSetting.type == NetworkAdapter::WIFI && _getPid_() != OPTA_WIFI_PID) {
     DEBUG_WARNING("NetworkConfiguratorClass::%s WiFi configuration is not supported on this board", __FUNCTION__);
     sendStatus(StatusMessage::INVALID_PARAMS);
-    return false;
+    return ConnectionResult::FAILED;
   }
 #endif
 
@@ -375,7 +544,7 @@ bool NetworkConfiguratorClass::handleConnectRequest() {
       DEBUG_ERROR("NetworkConfiguratorClass::%s error initializing kvstore", __FUNCTION__);
       sendStatus(StatusMessage::ERROR_STORAGE_BEGIN);
       _ledFeedback->setMode(LEDFeedbackClass::LEDFeedbackMode::ERROR);
-      return false;
+      return ConnectionResult::FAILED;
     }
     bool storeResult = _kvstore->putBytes(STORAGE_KEY, (uint8_t *)&_networkSetting, sizeof(models::NetworkSetting));
 
@@ -384,18 +553,20 @@ bool NetworkConfiguratorClass::handleConnectRequest() {
       DEBUG_ERROR("NetworkConfiguratorClass::%s error saving network settings", __FUNCTION__);
       sendStatus(StatusMessage::ERROR);
       _ledFeedback->setMode(LEDFeedbackClass::LEDFeedbackMode::ERROR);
-      return false;
+      return ConnectionResult::FAILED;
     }
   }
 
   if (_connectionHandlerIstantiated) {
-    if(disconnectFromNetwork() == ConnectionResult::FAILED) {
-      sendStatus(StatusMessage::ERROR);
-      _ledFeedback->setMode(LEDFeedbackClass::LEDFeedbackMode::ERROR);
-      return false;
-    }
+    // The new settings are applied by handleDisconnecting() when the current connection is closed
+    startDisconnection(NetworkConfiguratorStates::CONNECTING);
+    return ConnectionResult::IN_PROGRESS;
   }
 
+  return applyNetworkSettings() ? ConnectionResult::SUCCESS : ConnectionResult::FAILED;
+}
+
+bool NetworkConfiguratorClass::applyNetworkSettings() {
   if (!_connectionHandler->updateSetting(_networkSetting)) {
     sendStatus(StatusMessage::INVALID_PARAMS);
     return false;
@@ -542,11 +713,9 @@ NetworkConfiguratorStates NetworkConfiguratorClass::handleZeroTouchConfig() {
     return NetworkConfiguratorStates::CONFIGURED;
   } else if (connectionRes == ConnectionResult::FAILED) {
     DEBUG_VERBOSE("NetworkConfiguratorClass::%s Connection eth fail", __FUNCTION__);
-    if(disconnectFromNetwork() == ConnectionResult::FAILED) {
-      sendStatus(StatusMessage::ERROR);
-    }
+    startDisconnection(NetworkConfiguratorStates::WAITING_FOR_CONFIG);
     _connectionHandlerIstantiated = false;
-    return NetworkConfiguratorStates::WAITING_FOR_CONFIG;
+    return NetworkConfiguratorStates::DISCONNECTING;
   }
 
   return handleWaitingForConf();
@@ -592,7 +761,7 @@ NetworkConfiguratorStates NetworkConfiguratorClass::handleReadStorage() {
   }
 
   if (_optionUpdateTimer.getWaitTime() == 0) {
-    scanNetworkOptions();
+    requestScan();
   }
   /*
    * If the board is zero touch capable and without network configuration, it starts the zero touch configuration mode
@@ -609,24 +778,28 @@ NetworkConfiguratorStates NetworkConfiguratorClass::handleReadStorage() {
 NetworkConfiguratorStates NetworkConfiguratorClass::handleWaitingForConf() {
   NetworkConfiguratorStates nextState = _state;
   _agentsManager->update();
-  bool connecting = false;
+  ConnectionResult connectRes = ConnectionResult::FAILED;
   switch (_receivedEvent) {
-    case NetworkConfiguratorEvents::SCAN_REQ:                 scanNetworkOptions        (); break;
-    case NetworkConfiguratorEvents::CONNECT_REQ: connecting = handleConnectRequest      (); break;
+    case NetworkConfiguratorEvents::SCAN_REQ:                 requestScan               (); break;
+    case NetworkConfiguratorEvents::CONNECT_REQ: connectRes = handleConnectRequest      (); break;
     case NetworkConfiguratorEvents::GET_WIFI_FW_VERSION:      handleGetWiFiFWVersion    (); break;
     case NetworkConfiguratorEvents::GET_NET_CONF_LIB_VERSION: handleGetNetConfLibVersion(); break;
     case NetworkConfiguratorEvents::NEW_NETWORK_SETTINGS:                                   break;
   }
   _receivedEvent = NetworkConfiguratorEvents::NONE;
 
-  if((_connectionHandlerIstantiated && _agentsManager->isConfigInProgress() != true && _connectionRetryTimer.isExpired()) || connecting){
+  if (connectRes == ConnectionResult::IN_PROGRESS) {
+    return NetworkConfiguratorStates::DISCONNECTING;
+  }
+
+  if((_connectionHandlerIstantiated && _agentsManager->isConfigInProgress() != true && _connectionRetryTimer.isExpired()) || connectRes == ConnectionResult::SUCCESS){
     sendStatus(StatusMessage::CONNECTING);
     return NetworkConfiguratorStates::CONNECTING;
   }
 
   //Check if update the network options
   if (_optionUpdateTimer.isExpired()) {
-    scanNetworkOptions();
+    requestScan();
   }
 
   return nextState;
@@ -659,7 +832,7 @@ NetworkConfiguratorStates NetworkConfiguratorClass::handleConfigured() {
   if (_configInProgress != updatedConfigInprogress) {
     _configInProgress = updatedConfigInprogress;
     if (_configInProgress) {
-      scanNetworkOptions();
+      requestScan();
       return NetworkConfiguratorStates::UPDATING_CONFIG;
     }
   }
@@ -678,6 +851,38 @@ NetworkConfiguratorStates NetworkConfiguratorClass::handleUpdatingConfig() {
   return handleWaitingForConf();
 }
 
+NetworkConfiguratorStates NetworkConfiguratorClass::handleDisconnecting() {
+  _agentsManager->update();  //To keep alive the connection with the configurator
+  NetworkConnectionState connectionRes = _connectionHandler->check();
+  if (connectionRes != NetworkConnectionState::CLOSED && !_disconnectionTimeout.isExpired()) {
+    return NetworkConfiguratorStates::DISCONNECTING;
+  }
+
+  _disconnecting = false;
+
+  if (connectionRes != NetworkConnectionState::CLOSED) {
+    DEBUG_WARNING("NetworkConfiguratorClass::%s Disconnection timeout", __FUNCTION__);
+    sendStatus(StatusMessage::ERROR);
+    if (_stateAfterDisconnection == NetworkConfiguratorStates::CONNECTING) {
+      _ledFeedback->setMode(LEDFeedbackClass::LEDFeedbackMode::ERROR);
+      return NetworkConfiguratorStates::WAITING_FOR_CONFIG;
+    }
+    return _stateAfterDisconnection;
+  }
+
+  // Reset the connection handler to INIT state
+  _connectionHandler->connect();
+
+  if (_stateAfterDisconnection == NetworkConfiguratorStates::CONNECTING) {
+    if (!applyNetworkSettings()) {
+      return NetworkConfiguratorStates::WAITING_FOR_CONFIG;
+    }
+    sendStatus(StatusMessage::CONNECTING);
+  }
+
+  return _stateAfterDisconnection;
+}
+
 NetworkConfiguratorStates NetworkConfiguratorClass::handleErrorState() {
   _agentsManager->update();
   return NetworkConfiguratorStates::ERROR;
@@ -29,6 +29,7 @@
  * - CONNECTING: Attempts to connect to the network using the provided configuration.
  * - CONFIGURED: Indicates that the ConnectionHanlder has been successfully configured.
  * - UPDATING_CONFIG: Updates the network configuration.
+ * - DISCONNECTING: Waits for the ConnectionHandler to close the current connection before applying a new configuration.
  * - ERROR: Represents an error state during the configuration process.
  * - END: Marks the end of the network configuration process.
  */
@@ -38,6 +39,7 @@ enum class NetworkConfiguratorStates { ZERO_TOUCH_CONFIG,
                                        CONNECTING,
                                        CONFIGURED,
                                        UPDATING_CONFIG,
+                                       DISCONNECTING,
                                        ERROR,
                                        END };
 
@@ -166,6 +168,9 @@ private:
   static inline models::NetworkSetting _networkSetting;
   bool _connectionHandlerIstantiated;
   bool _configInProgress;
+  bool _disconnecting;
+  // State entered when the ConnectionHandler is closed, CONNECTING for applying the new network settings
+  NetworkConfiguratorStates _stateAfterDisconnection;
   ResetInput *_resetInput;
   LEDFeedbackClass *_ledFeedback;
   /* Timeout instances */
@@ -175,6 +180,8 @@ private:
   TimedAttempt _connectionRetryTimer;
   // Timeout for updating the network options ex. periodically scanning for new WiFi networks
   TimedAttempt _optionUpdateTimer;
+  // Timeout for waiting the ConnectionHandler to close the connection
+  TimedAttempt _disconnectionTimeout;
   /* List of events the NetworkConfigurator can handle from the AgentsManager */
   enum class NetworkConfiguratorEvents { NONE,
                                          SCAN_REQ,
@@ -183,6 +190,14 @@ private:
                                          GET_WIFI_FW_VERSION,
                                          GET_NET_CONF_LIB_VERSION };
   static inline NetworkConfiguratorEvents _receivedEvent;
+  /* The WiFi scan blocks, it's started only after the SCANNING status has been written to the peer
+   * - REQUESTED: the SCANNING status has been enqueued during the current update()
+   * - WAITING_STATUS: the SCANNING status is still being written, a change of state cancels the scan
+   */
+  enum class ScanStates { NONE,
+                          REQUESTED,
+                          WAITING_STATUS };
+  ScanStates _scanState;
 
   enum class ConnectionResult { SUCCESS,
                                 FAILED,
@@ -200,8 +215,10 @@ private:
   NetworkConfiguratorStates handleConnecting();
   NetworkConfiguratorStates handleConfigured();
   NetworkConfiguratorStates handleUpdatingConfig();
+  NetworkConfiguratorStates handleDisconnecting();
   NetworkConfiguratorStates handleErrorState();
-  bool handleConnectRequest();
+  ConnectionResult handleConnectRequest();
+  bool applyNetworkSettings();
   void handleGetWiFiFWVersion();
   void handleGetNetConfLibVersion();
 
@@ -212,7 +229,10 @@ private:
 
   String decodeConnectionErrorMessage(NetworkConnectionState err, StatusMessage *errorCode);
   ConnectionResult connectToNetwork(StatusMessage *err);
-  ConnectionResult disconnectFromNetwork();
+  void startDisconnection(NetworkConfiguratorStates nextState);
+  void requestScan();
+  bool isScanAllowed();
+  bool sendNetworkOptions();
   bool sendStatus(StatusMessage msg);
   static void printNetworkSettings();
 #ifdef BOARD_HAS_ETHERNET
@@ -156,6 +156,9 @@ bool AgentsManagerClass::sendMsg(ProvisioningOutputMessage &msg) {
   }
 
   if(_state == AgentsManagerStates::CONFIG_IN_PROGRESS) {
+    if(msg.type == MessageOutputType::NETWORK_OPTIONS) {
+      return sendNetworkOptions(msg.m.netOptions);
+    }
     return _selectedAgent->sendMsg(msg);
   }
   return true;
@@ -194,9 +197,10 @@ void AgentsManagerClass::removeReturnTimestampCallback() {
   _returnTimestampCb = nullptr;
 }
 
-bool AgentsManagerClass::addReturnNetworkSettingsCallback(ReturnNetworkSettings callback) {
-  if (_returnNetworkSettingsCb == nullptr) {
+bool AgentsManagerClass::addReturnNetworkSettingsCallback(ReturnNetworkSettings callback, models::NetworkSetting *netSetting) {
+  if (_returnNetworkSettingsCb == nullptr && netSetting != nullptr) {
     _returnNetworkSettingsCb = callback;
+    _receivedNetSetting = netSetting;
     return true;
   }
   return false;
@@ -204,12 +208,17 @@ bool AgentsManagerClass::addReturnNetworkSettingsCallback(ReturnNetworkSettings
 
 void AgentsManagerClass::removeReturnNetworkSettingsCallback() {
   _returnNetworkSettingsCb = nullptr;
+  _receivedNetSetting = nullptr;
 }
 
 bool AgentsManagerClass::isConfigInProgress() {
   return _state != AgentsManagerStates::INIT && _state != AgentsManagerStates::END;
 }
 
+bool AgentsManagerClass::isSendingMsg() {
+  return _state == AgentsManagerStates::CONFIG_IN_PROGRESS && _selectedAgent != nullptr && _selectedAgent->isSendingMsg();
+}
+
 /******************************************************************************
  * PRIVATE MEMBER FUNCTIONS
  ******************************************************************************/
@@ -218,6 +227,7 @@ AgentsManagerClass::AgentsManagerClass():
   _netOptions{ .type = NetworkOptionsClass::NONE },
   _returnTimestampCb{ nullptr },
   _returnNetworkSettingsCb{ nullptr },
+  _receivedNetSetting{ nullptr },
   _selectedAgent{ nullptr },
   _instances{ 0 },
   _initStatusMsg{ StatusMessage::NONE },
@@ -225,6 +235,11 @@ AgentsManagerClass::AgentsManagerClass():
   _state{ AgentsManagerStates::END }
   {
     memset(_enabledAgents, 0x01, sizeof(_enabledAgents));
+#ifdef BOARD_HAS_WIFI
+    _netOptionsUpdates = false;
+    _netOptionsResync = false;
+    _sentWiFiNetworks.num = 0;
+#endif
   }
 
 AgentsManagerStates AgentsManagerClass::handleInit() {
@@ -269,9 +284,7 @@ AgentsManagerStates AgentsManagerClass::handleSendInitialStatus() {
 }
 
 AgentsManagerStates AgentsManagerClass::handleSendNetworkOptions() {
-  ProvisioningOutputMessage networkOptionMsg = { MessageOutputType::NETWORK_OPTIONS };
-  networkOptionMsg.m.netOptions = &_netOptions;
-  if (_selectedAgent->sendMsg(networkOptionMsg)) {
+  if (sendNetworkOptions(&_netOptions)) {
     return AgentsManagerStates::CONFIG_IN_PROGRESS;
   }
   return AgentsManagerStates::SEND_NETWORK_OPTIONS;
@@ -354,6 +367,7 @@ void AgentsManagerClass::handleReceivedCommands(RemoteCommands cmd) {
   switch (cmd) {
     case RemoteCommands::CONNECT:                         type = RequestType::CONNECT                        ; break;
     case RemoteCommands::SCAN:                            type = RequestType::SCAN                           ; break;
+    case RemoteCommands::SCAN_UPDATES:                    type = RequestType::SCAN                           ; break;
     case RemoteCommands::GET_ID:                          type = RequestType::GET_ID                         ; break;
     case RemoteCommands::GET_BLE_MAC_ADDRESS:             type = RequestType::GET_BLE_MAC_ADDRESS            ; break;
     case RemoteCommands::RESET:                           type = RequestType::RESET                          ; break;
@@ -374,6 +388,14 @@ void AgentsManagerClass::handleReceivedCommands(RemoteCommands cmd) {
     return;
   }
 
+#ifdef BOARD_HAS_WIFI
+  if (cmd == RemoteCommands::SCAN) {
+    _netOptionsResync = true;
+  } else if (cmd == RemoteCommands::SCAN_UPDATES) {
+    _netOptionsUpdates = true;
+  }
+#endif
+
   _statusRequest.pending = true;
   _statusRequest.key = type;
   reqHandler();
@@ -384,6 +406,7 @@ void AgentsManagerClass::handleReceivedData() {
     return;
   }
   ProvisioningInputMessage msg;
+  msg.netSetting = _receivedNetSetting;
   if (!_selectedAgent->getReceivedMsg(msg)) {
     DEBUG_WARNING("AgentsManagerClass::%s failed to get received data", __FUNCTION__);
     return;
@@ -397,7 +420,7 @@ void AgentsManagerClass::handleReceivedData() {
       break;
     case MessageInputType::NETWORK_SETTINGS:
       if (_returnNetworkSettingsCb != nullptr) {
-        _returnNetworkSettingsCb(&msg.m.netSetting);
+        _returnNetworkSettingsCb(msg.netSetting);
       }
       break;
     case MessageInputType::COMMANDS:
@@ -426,7 +449,112 @@ void AgentsManagerClass::handlePeerDisconnected() {
     }
   }
   _selectedAgent = nullptr;
+#ifdef BOARD_HAS_WIFI
+  _netOptionsUpdates = false;
+  _netOptionsResync = false;
+#endif
   return;
 }
 
+bool AgentsManagerClass::sendNetworkOptions(const NetworkOptions *netOptions) {
+  ProvisioningOutputMessage networkOptionMsg = { MessageOutputType::NETWORK_OPTIONS };
+  networkOptionMsg.m.netOptions = netOptions;
+
+#ifdef BOARD_HAS_WIFI
+  if (netOptions->type != NetworkOptionsClass::WIFI) {
+    return _selectedAgent->sendMsg(networkOptionMsg);
+  }
+
+  if (_netOptionsUpdates && !_netOptionsResync) {
+    NetworkOptions update = { .type = NetworkOptionsClass::WIFI };
+    // If the update is bigger than the list or a sent network is no more available, the full list is sent
+    if (buildWiFiOptionsUpdate(netOptions->option.wifi, update.option.wifi)) {
+      if (update.option.wifi.numDiscoveredWiFiNetworks == 0) {
+        // Nothing changed since the last list sent
+        return true;
+      }
+      ProvisioningOutputMessage updateMsg = { MessageOutputType::NETWORK_OPTIONS_UPDATE };
+      updateMsg.m.netOptions = &update;
+      if (!_selectedAgent->sendMsg(updateMsg)) {
+        return false;
+      }
+      applySentWiFiOptionsUpdate(update.option.wifi);
+      return true;
+    }
+  }
+
+  if (!_selectedAgent->sendMsg(networkOptionMsg)) {
+    return false;
+  }
+  storeSentWiFiOptions(netOptions->option.wifi);
+  _netOptionsResync = false;
+  return true;
+#else
+  return _selectedAgent->sendMsg(networkOptionMsg);
+#endif
+}
+
+#ifdef BOARD_HAS_WIFI
+static int8_t compactRSSI(int rssi) {
+  return rssi < INT8_MIN ? INT8_MIN : (rssi > INT8_MAX ? INT8_MAX : rssi);
+}
+
+int AgentsManagerClass::findSentWiFiNetwork(uint32_t ssidHash) {
+  for (uint8_t i = 0; i < _sentWiFiNetworks.num; i++) {
+    if (_sentWiFiNetworks.SSIDHash[i] == ssidHash) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool AgentsManagerClass::buildWiFiOptionsUpdate(const WiFiOption &wifiOptions, WiFiOption &update) {
+  uint8_t found = 0;
+  update.numDiscoveredWiFiNetworks = 0;
+
+  for (int i = 0; i < wifiOptions.numDiscoveredWiFiNetworks; i++) {
+    const DiscoveredWiFiNetwork &network = wifiOptions.discoveredWifiNetworks[i];
+    int idx = findSentWiFiNetwork(wifiOptions.SSIDHash[i]);
+    if (idx >= 0) {
+      found++;
+      if (abs(compactRSSI(network.RSSI) - _sentWiFiNetworks.RSSI[idx]) < NETWORK_OPTIONS_UPDATE_RSSI_THRESHOLD) {
+        continue;
+      }
+    }
+
+    if (update.numDiscoveredWiFiNetworks == MAX_WIFI_NETWORKS) {
+      return false;
+    }
+    update.SSIDHash[update.numDiscoveredWiFiNetworks] = wifiOptions.SSIDHash[i];
+    update.discoveredWifiNetworks[update.numDiscoveredWiFiNetworks++] = network;
+  }
+
+  /* Only the hash of the SSIDs known by the peer is stored, the SSID of a network
+   * no more available can't be sent, so the full list is sent instead
+   */
+  return found == _sentWiFiNetworks.num;
+}
+
+void AgentsManagerClass::storeSentWiFiOptions(const WiFiOption &wifiOptions) {
+  _sentWiFiNetworks.num = wifiOptions.numDiscoveredWiFiNetworks;
+  for (uint8_t i = 0; i < _sentWiFiNetworks.num; i++) {
+    _sentWiFiNetworks.SSIDHash[i] = wifiOptions.SSIDHash[i];
+    _sentWiFiNetworks.RSSI[i] = compactRSSI(wifiOptions.discoveredWifiNetworks[i].RSSI);
+  }
+}
+
+void AgentsManagerClass::applySentWiFiOptionsUpdate(const WiFiOption &update) {
+  for (int i = 0; i < update.numDiscoveredWiFiNetworks; i++) {
+    int8_t rssi = compactRSSI(update.discoveredWifiNetworks[i].RSSI);
+    int idx = findSentWiFiNetwork(update.SSIDHash[i]);
+    if (idx >= 0) {
+      _sentWiFiNetworks.RSSI[idx] = rssi;
+    } else if (_sentWiFiNetworks.num < MAX_WIFI_NETWORKS) {
+      _sentWiFiNetworks.SSIDHash[_sentWiFiNetworks.num] = update.SSIDHash[i];
+      _sentWiFiNetworks.RSSI[_sentWiFiNetworks.num++] = rssi;
+    }
+  }
+}
+#endif
+
 #endif // NETWORK_CONFIGURATOR_COMPATIBLE
@@ -190,10 +190,13 @@ public:
 
   /**
    * @brief Add a callback to return network settings received from the agent.
+   * The received network settings are decoded in place in netSetting, the callback
+   * is called with netSetting once a valid message has been decoded.
    * @param callback The callback function to return the network settings.
+   * @param netSetting The destination of the received network settings.
    * @return True if the callback is successfully added, false otherwise.
    */
-  bool addReturnNetworkSettingsCallback(ReturnNetworkSettings callback);
+  bool addReturnNetworkSettingsCallback(ReturnNetworkSettings callback, models::NetworkSetting *netSetting);
 
   /**
    * @brief Remove the callback for returning network settings.
@@ -206,6 +209,12 @@ public:
    */
   bool isConfigInProgress();
 
+  /**
+   * @brief Check if the messages sent are still being written to the connected peer.
+   * @return True if a sent message has not been completely written yet, false otherwise.
+   */
+  bool isSendingMsg();
+
 private:
   AgentsManagerClass();
   AgentsManagerStates _state;
@@ -214,10 +223,26 @@ private:
   ConfiguratorRequestHandler _reqHandlers[8];
   ReturnTimestamp _returnTimestampCb;
   ReturnNetworkSettings _returnNetworkSettingsCb;
+  models::NetworkSetting *_receivedNetSetting;
   ConfiguratorAgent *_selectedAgent;
   uint8_t _instances;
   StatusMessage _initStatusMsg;
   NetworkOptions _netOptions;
+#ifdef BOARD_HAS_WIFI
+  // The peer requested the SCAN_UPDATES, the following scans are sent as updates of the last sent list
+  bool _netOptionsUpdates;
+  // The peer requested a SCAN, the next list is sent in full
+  bool _netOptionsResync;
+  /* WiFi networks known by the peer, identified by the FNV-1a hash of the SSID computed while scanning.
+   * 5 bytes per network, the RSSI is stored in dBm
+   */
+  typedef struct {
+    uint32_t SSIDHash[MAX_WIFI_NETWORKS];
+    int8_t RSSI[MAX_WIFI_NETWORKS];
+    uint8_t num;
+  } SentWiFiNetworks;
+  SentWiFiNetworks _sentWiFiNetworks;
+#endif
   typedef struct {
     void reset() {
       pending = false;
@@ -241,6 +266,13 @@ private:
   void handleReceivedData();
 
   bool sendStatus(StatusMessage msg);
+  bool sendNetworkOptions(const NetworkOptions *netOptions);
+#ifdef BOARD_HAS_WIFI
+  int findSentWiFiNetwork(uint32_t ssidHash);
+  bool buildWiFiOptionsUpdate(const WiFiOption &wifiOptions, WiFiOption &update);
+  void storeSentWiFiOptions(const WiFiOption &wifiOptions);
+  void applySentWiFiOptionsUpdate(const WiFiOption &update);
+#endif
 
   void handlePeerDisconnected();
 };
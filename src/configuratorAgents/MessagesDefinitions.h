@@ -48,6 +48,7 @@ enum class RemoteCommands { CONNECT                         = 1,
                             RESET                           = 4,
                             SCAN                            = 100,
                             GET_WIFI_FW_VERSION             = 101,
+                            SCAN_UPDATES                    = 102,
                             GET_PROVISIONING_SKETCH_VERSION = 200,
                             GET_NETCONFIG_LIB_VERSION       = 201,
 };
@@ -55,6 +56,7 @@ enum class RemoteCommands { CONNECT                         = 1,
 /* Types of outgoing messages */
 enum class MessageOutputType { STATUS,
                                NETWORK_OPTIONS,
+                               NETWORK_OPTIONS_UPDATE,
                                UHWID,
                                JWT,
                                BLE_MAC_ADDRESS,
@@ -80,7 +82,7 @@ struct ProvisioningOutputMessage {
   MessageOutputType type;
   union {
     StatusMessage status;
-    const NetworkOptions *netOptions;
+    const NetworkOptions *netOptions; // Also used by NETWORK_OPTIONS_UPDATE
     const byte *uhwid; // Must be a pointer to a byte array of MAX_UHWID_SIZE
     const char *jwt;
     const uint8_t *BLEMacAddress;
@@ -98,7 +100,8 @@ struct ProvisioningInputMessage {
   MessageInputType type;
   union {
     RemoteCommands cmd;
-    models::NetworkSetting netSetting;
     uint64_t timestamp;
   } m;
+  // Destination provided by the receiver, a NETWORK_SETTINGS message is decoded in place here. If nullptr the network settings are discarded
+  models::NetworkSetting *netSetting;
 };
@@ -8,7 +8,13 @@
 
 #pragma once
 #include "Arduino.h"
-#define MAX_WIFI_NETWORKS 20
+#include "ANetworkConfigurator_Config.h"
+
+static_assert(MAX_WIFI_NETWORKS <= 254, "MAX_WIFI_NETWORKS must fit the uint8_t indexes of the SSID hash set");
+
+#define MAX_WIFI_SSID_SIZE 33 // Max length of ssid is 32 + \0
+/* Size of the hash set of the scanned SSIDs, twice the networks for keeping the probe sequences short */
+#define WIFI_SSID_SET_SIZE (2 * MAX_WIFI_NETWORKS)
 
 /*
  * Structures for storing the available network options
@@ -27,6 +33,11 @@ typedef struct {
 struct WiFiOption {
   DiscoveredWiFiNetwork discoveredWifiNetworks[MAX_WIFI_NETWORKS];
   int numDiscoveredWiFiNetworks = 0;
+  /* Open addressing hash set used for discarding the duplicated SSIDs of a scan.
+   * A slot stores the index of the network + 1, 0 marks an empty slot
+   */
+  uint8_t SSIDSet[WIFI_SSID_SET_SIZE] = { 0 };
+  uint32_t SSIDHash[MAX_WIFI_NETWORKS];
 };
 
 struct NetworkOptions {
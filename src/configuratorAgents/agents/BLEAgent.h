@@ -21,6 +21,7 @@
 #include "configuratorAgents/agents/boardConfigurationProtocol/cbor/CBORInstances.h"
 
 #define BASE_LOCAL_NAME "Arduino"
+#define BLE_DISCONNECT_TIMEOUT_MS 200
 #define ARDUINO_COMPANY_ID 0x09A3
 
 #if defined(ARDUINO_SAMD_MKRWIFI1010) || defined(ARDUINO_SAMD_NANO_33_IOT)
@@ -60,6 +61,7 @@ public:
   bool receivedMsgAvailable();
   bool getReceivedMsg(ProvisioningInputMessage &msg);
   bool sendMsg(ProvisioningOutputMessage &msg);
+  bool isSendingMsg();
   bool isPeerConnected();
   inline AgentTypes getAgentType() {
     return AgentTypes::BLE;
@@ -70,27 +72,35 @@ private:
                         SUBSCRIBED };
 
   static inline BLEEvent _bleEvent = BLEEvent::NONE;
+  // The agent receiving the bytes written by the peer, set by begin()
+  static inline BLEAgentClass *_instance = nullptr;
   AgentConfiguratorStates _state = AgentConfiguratorStates::END;
   BLEService _confService;  // BLE Configuration Service
   BLECharacteristic _inputStreamCharacteristic;
   BLECharacteristic _outputStreamCharacteristic;
   String _localName;
   uint8_t _manufacturerData[8];
-  size_t _readByte = 0;
+  bool _disconnecting = false;
+  bool _draining = false;
+  uint32_t _disconnectStartTs = 0;
 
   /*BLEAgent private methods*/
   AgentConfiguratorStates handlePeerConnected();
+  void handleInputStreamWritten(BLECharacteristic &characteristic);
+  void handleDisconnecting();
   bool setLocalName();
   bool setManufacturerData();
 
   /*ArduinoBLE events callback functions*/
   static void blePeripheralDisconnectHandler(BLEDevice central);
   static void bleOutputStreamSubscribed(BLEDevice central, BLECharacteristic characteristic);
+  static void bleInputStreamWritten(BLEDevice central, BLECharacteristic characteristic);
 
   /*BoardConfigurationProtocol pure virtual methods implementation*/
   bool received();
   size_t available();
   uint8_t read();
+  size_t readBytes(uint8_t *data, size_t len);
   int write(const uint8_t *data, size_t len);
   void handleDisconnectRequest();
   void clearInputBuffer();
@@ -99,7 +109,7 @@ private:
 inline BLEAgentClass::BLEAgentClass()
   : _confService{ "5e5be887-c816-4d4f-b431-9eb34b02f4d9" },
     _inputStreamCharacteristic{ "0000ffe1-0000-1000-8000-00805f9b34fc", BLEWrite, 256 },
-    _outputStreamCharacteristic{ "0000ffe1-0000-1000-8000-00805f9b34fa", BLEIndicate, 64 } {
+    _outputStreamCharacteristic{ "0000ffe1-0000-1000-8000-00805f9b34fa", BLEIndicate | BLENotify, BLE_AGENT_MAX_FRAGMENT_SIZE } {
 }
 
 inline ConfiguratorAgent::AgentConfiguratorStates BLEAgentClass::begin() {
@@ -123,8 +133,10 @@ inline ConfiguratorAgent::AgentConfiguratorStates BLEAgentClass::begin() {
 
   BLE.setAdvertisedService(_confService);
 
+  _instance = this;
   BLE.setEventHandler(BLEDisconnected, blePeripheralDisconnectHandler);
   _outputStreamCharacteristic.setEventHandler(BLESubscribed, bleOutputStreamSubscribed);
+  _inputStreamCharacteristic.setEventHandler(BLEWritten, bleInputStreamWritten);
 
   // add the characteristic to the service
   _confService.addCharacteristic(_outputStreamCharacteristic);
@@ -147,8 +159,16 @@ inline ConfiguratorAgent::AgentConfiguratorStates BLEAgentClass::end() {
     if (_state != AgentConfiguratorStates::INIT) {
       disconnectPeer();
     }
+    if (_draining) {
+      // The agent is not updated anymore, the DISCONNECT message is written before closing the link
+      drainOutput(BLE_DISCONNECT_TIMEOUT_MS);
+      BLE.disconnect();
+    }
+    _draining = false;
     BLE.stopAdvertise();
     BLE.end();
+    _instance = nullptr;
+    _disconnecting = false;
     clear();
     LEDFeedbackClass::getInstance().setMode(LEDFeedbackClass::LEDFeedbackMode::NONE);
     _state = AgentConfiguratorStates::END;
@@ -165,13 +185,18 @@ inline ConfiguratorAgent::AgentConfiguratorStates BLEAgentClass::update() {
 
   switch (_bleEvent) {
     case BLEEvent::SUBSCRIBED:
+      if (_disconnecting) {
+        DEBUG_DEBUG("BLEAgentClass::%s subscription ignored, disconnection in progress", __FUNCTION__);
+        break;
+      }
       if (_state != AgentConfiguratorStates::PEER_CONNECTED) {
         _state = AgentConfiguratorStates::PEER_CONNECTED;
         LEDFeedbackClass::getInstance().setMode(LEDFeedbackClass::LEDFeedbackMode::PEER_CONNECTED);
       }
       break;
     case BLEEvent::DISCONNECTED:
-      _inputStreamCharacteristic.writeValue("");
+      _disconnecting = false;
+      _draining = false;
       clear();
       LEDFeedbackClass::getInstance().setMode(LEDFeedbackClass::LEDFeedbackMode::BLE_AVAILABLE);
       _state = AgentConfiguratorStates::INIT;
@@ -181,10 +206,14 @@ inline ConfiguratorAgent::AgentConfiguratorStates BLEAgentClass::update() {
   }
   _bleEvent = BLEEvent::NONE;
 
+  if (_disconnecting) {
+    handleDisconnecting();
+  }
+
   switch (_state) {
     case AgentConfiguratorStates::INIT:                                           break;
     case AgentConfiguratorStates::PEER_CONNECTED: _state = handlePeerConnected(); break;
-    case AgentConfiguratorStates::RECEIVED_DATA:                                  break;
+    case AgentConfiguratorStates::RECEIVED_DATA:  transmitStream();               break;
     case AgentConfiguratorStates::ERROR:                                          break;
     case AgentConfiguratorStates::END:                                            break;
   }
@@ -210,6 +239,10 @@ inline bool BLEAgentClass::sendMsg(ProvisioningOutputMessage &msg) {
   return BoardConfigurationProtocol::sendMsg(msg);
 }
 
+inline bool BLEAgentClass::isSendingMsg() {
+  return BoardConfigurationProtocol::pendingOutput();
+}
+
 inline bool BLEAgentClass::isPeerConnected() {
   return _outputStreamCharacteristic.subscribed() && (_state == AgentConfiguratorStates::PEER_CONNECTED || _state == AgentConfiguratorStates::RECEIVED_DATA);
 }
@@ -225,28 +258,47 @@ inline void BLEAgentClass::bleOutputStreamSubscribed(BLEDevice central, BLEChara
   DEBUG_INFO("BLEAgentClass Connected event, central: %s", central.address().c_str());
 }
 
-inline bool BLEAgentClass::received() {
-  bool res = _inputStreamCharacteristic.written();
-  if (res) {
-    _readByte = 0;
+inline void BLEAgentClass::bleInputStreamWritten(BLEDevice central, BLECharacteristic characteristic) {
+  if (_instance != nullptr) {
+    _instance->handleInputStreamWritten(characteristic);
   }
-  return res;
+}
+
+inline void BLEAgentClass::handleInputStreamWritten(BLECharacteristic &characteristic) {
+  // The event is fired during BLE.poll(): the written value is parsed in place before the peer can overwrite it
+  if (_disconnecting || (_state != AgentConfiguratorStates::PEER_CONNECTED && _state != AgentConfiguratorStates::RECEIVED_DATA)) {
+    return;
+  }
+
+  if (receiveChunk(characteristic.value(), characteristic.valueLength()) == TransmissionResult::DATA_RECEIVED) {
+    _state = AgentConfiguratorStates::RECEIVED_DATA;
+  }
+}
+
+// The bytes written by the peer are parsed by the BLEWritten event handler, nothing is left to read
+inline bool BLEAgentClass::received() {
+  return false;
 }
 
 inline size_t BLEAgentClass::available() {
-  return _inputStreamCharacteristic.valueLength();
+  return 0;
 }
 
 inline uint8_t BLEAgentClass::read() {
-  const uint8_t *charValue = _inputStreamCharacteristic.value();
-  if (_readByte < _inputStreamCharacteristic.valueLength()) {
-    return charValue[_readByte++];
-  }
+  return 0;
+}
+
+inline size_t BLEAgentClass::readBytes(uint8_t * /*data*/, size_t /*len*/) {
   return 0;
 }
 
 inline int BLEAgentClass::write(const uint8_t *data, size_t len) {
-  return _outputStreamCharacteristic.writeValue(data, len);
+  // The peer chooses notifications or indications subscribing the output characteristic
+  // Each one carries a fragment of the packet that fits the ATT MTU of the peer
+  size_t fragmentLen = len < BLE_AGENT_MAX_FRAGMENT_SIZE ? len : BLE_AGENT_MAX_FRAGMENT_SIZE;
+  // Depending on the BLE stack version writeValue returns the value length or a success flag, not the bytes sent
+  int res = _outputStreamCharacteristic.writeValue(data, fragmentLen);
+  return res > 0 ? (int)fragmentLen : res;
 }
 
 inline void BLEAgentClass::handleDisconnectRequest() {
@@ -257,10 +309,6 @@ inline ConfiguratorAgent::AgentConfiguratorStates BLEAgentClass::handlePeerConne
 
   TransmissionResult res = sendAndReceive();
   switch (res) {
-    case TransmissionResult::INVALID_DATA:
-      // clear the input buffer
-      _inputStreamCharacteristic.writeValue("");
-      break;
     case TransmissionResult::PEER_NOT_AVAILABLE:
       disconnectPeer();
       nextState = AgentConfiguratorStates::INIT;
@@ -308,19 +356,44 @@ inline bool BLEAgentClass::setManufacturerData() {
 
 
 inline void BLEAgentClass::disconnectPeer() {
-  _inputStreamCharacteristic.writeValue("");
-  uint32_t start = millis();
-  BLE.disconnect();
-  do {
-    BLE.poll();
-  } while (millis() - start < 200);
-  clear();
+  if (isPeerConnected()) {
+    uint8_t data = (uint8_t)PacketManager::TransmissionControlMessage::DISCONNECT;
+    sendData(PacketManager::MessageType::TRANSMISSION_CONTROL, &data, sizeof(data));
+    clearInput();
+    // The pending output and the DISCONNECT message are written by update(), then the link is closed
+    _draining = true;
+  } else {
+    // The peer is not subscribed to the output stream, nothing can be written to it
+    clear();
+    BLE.disconnect();
+  }
+  _disconnecting = true;
+  _disconnectStartTs = millis();
   LEDFeedbackClass::getInstance().setMode(LEDFeedbackClass::LEDFeedbackMode::BLE_AVAILABLE);
   _state = AgentConfiguratorStates::INIT;
   return;
 }
 
+inline void BLEAgentClass::handleDisconnecting() {
+  // The data still written by the peer that is being disconnected is discarded by handleInputStreamWritten()
+  if (_draining) {
+    // One fragment is written per update, the link is closed when the queue is empty or after BLE_DISCONNECT_TIMEOUT_MS
+    if (transmitStream() == TransmissionResult::NOT_COMPLETED && millis() - _disconnectStartTs <= BLE_DISCONNECT_TIMEOUT_MS) {
+      return;
+    }
+    _draining = false;
+    clear();
+    // The disconnection is completed on the BLEDisconnected event or after BLE_DISCONNECT_TIMEOUT_MS
+    BLE.disconnect();
+    _disconnectStartTs = millis();
+    return;
+  }
+  if (millis() - _disconnectStartTs > BLE_DISCONNECT_TIMEOUT_MS) {
+    DEBUG_DEBUG("BLEAgentClass::%s disconnected event not received", __FUNCTION__);
+    _disconnecting = false;
+  }
+}
+
 inline void BLEAgentClass::clearInputBuffer() {
-  // clear the input buffer
-  _inputStreamCharacteristic.writeValue("");
+  // The written values are parsed when they are received, nothing is buffered by the agent
 }
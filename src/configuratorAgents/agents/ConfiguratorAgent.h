@@ -86,6 +86,14 @@ public:
    */
   virtual bool sendMsg(ProvisioningOutputMessage &msg) = 0;
 
+  /**
+   * @brief Check if the messages sent are still being written to the peer device.
+   * @return True if a sent message has not been completely written yet, false otherwise.
+   */
+  virtual bool isSendingMsg() {
+    return false;
+  }
+
   /**
    * @brief Check if a peer device is connected.
    * @return True if a peer device is connected, false otherwise.
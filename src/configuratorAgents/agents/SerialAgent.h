@@ -9,11 +9,14 @@
 #pragma once
 #include <list>
 #include "Arduino.h"
+#include "ANetworkConfigurator_Config.h"
 #include "configuratorAgents/agents/ConfiguratorAgent.h"
 #include "configuratorAgents/agents/boardConfigurationProtocol/BoardConfigurationProtocol.h"
 #include "configuratorAgents/agents/boardConfigurationProtocol/cbor/CBORInstances.h"
 #include "utility/LEDFeedback.h"
 
+#define SERIAL_DISCONNECT_TIMEOUT_MS 500
+
 /**
  * @class SerialAgentClass
  * @brief This class is responsible for managing serial communication with a peer device/client for board configuration purposes.
@@ -30,6 +33,7 @@ public:
   bool receivedMsgAvailable();
   bool getReceivedMsg(ProvisioningInputMessage &msg);
   bool sendMsg(ProvisioningOutputMessage &msg);
+  bool isSendingMsg();
   bool isPeerConnected();
   inline AgentTypes getAgentType() {
     return AgentTypes::USB_SERIAL;
@@ -37,15 +41,19 @@ public:
 private:
   AgentConfiguratorStates _state = AgentConfiguratorStates::END;
   bool _disconnectRequest = false;
+  bool _disconnecting = false;
+  uint32_t _disconnectStartTs = 0;
   PacketManager::Packet_t _packet;
   /*SerialAgent private methods*/
   AgentConfiguratorStates handleInit();
   AgentConfiguratorStates handlePeerConnected();
+  void handleDisconnecting();
 
   /*BoardConfigurationProtocol pure virtual methods implementation*/
   bool received();
   size_t available();
   uint8_t read();
+  size_t readBytes(uint8_t *data, size_t len);
   int write(const uint8_t *data, size_t len);
   void handleDisconnectRequest();
   void clearInputBuffer();
@@ -66,6 +74,11 @@ inline ConfiguratorAgent::AgentConfiguratorStates SerialAgentClass::end() {
     if (isPeerConnected()) {
       disconnectPeer();
     }
+    if (_disconnecting && Serial) {
+      // The agent is not updated anymore, the DISCONNECT message is written before releasing the queues
+      drainOutput(SERIAL_DISCONNECT_TIMEOUT_MS);
+    }
+    _disconnecting = false;
     clear();
     _state = AgentConfiguratorStates::END;
   }
@@ -74,6 +87,10 @@ inline ConfiguratorAgent::AgentConfiguratorStates SerialAgentClass::end() {
 
 inline ConfiguratorAgent::AgentConfiguratorStates SerialAgentClass::update() {
 
+  if (_disconnecting) {
+    handleDisconnecting();
+  }
+
   switch (_state) {
     case AgentConfiguratorStates::INIT:           _state = handleInit         (); break;
     case AgentConfiguratorStates::RECEIVED_DATA:
@@ -97,11 +114,22 @@ inline ConfiguratorAgent::AgentConfiguratorStates SerialAgentClass::update() {
 inline void SerialAgentClass::disconnectPeer() {
   uint8_t data = 0x02;
   sendData(PacketManager::MessageType::TRANSMISSION_CONTROL, &data, sizeof(data));
-  clear();
+  // The DISCONNECT message is queued after the pending output, they are written by update()
+  clearInput();
+  _disconnecting = true;
+  _disconnectStartTs = millis();
   LEDFeedbackClass::getInstance().setMode(LEDFeedbackClass::LEDFeedbackMode::NONE);
   _state = AgentConfiguratorStates::INIT;
 }
 
+inline void SerialAgentClass::handleDisconnecting() {
+  // One packet is written per update, the queue is released when empty or after SERIAL_DISCONNECT_TIMEOUT_MS
+  if (!Serial || transmitStream() == TransmissionResult::COMPLETED || millis() - _disconnectStartTs > SERIAL_DISCONNECT_TIMEOUT_MS) {
+    _disconnecting = false;
+    clear();
+  }
+}
+
 inline bool SerialAgentClass::getReceivedMsg(ProvisioningInputMessage &msg) {
   bool res = BoardConfigurationProtocol::getMsg(msg);
   if (receivedMsgAvailable() == false) {
@@ -118,6 +146,10 @@ inline bool SerialAgentClass::sendMsg(ProvisioningOutputMessage &msg) {
   return BoardConfigurationProtocol::sendMsg(msg);
 }
 
+inline bool SerialAgentClass::isSendingMsg() {
+  return BoardConfigurationProtocol::pendingOutput();
+}
+
 inline bool SerialAgentClass::isPeerConnected() {
   return Serial && (_state == AgentConfiguratorStates::PEER_CONNECTED || _state == AgentConfiguratorStates::RECEIVED_DATA);
 }
@@ -128,20 +160,29 @@ inline ConfiguratorAgent::AgentConfiguratorStates SerialAgentClass::handleInit()
     return nextState;
   }
 
-  while (Serial.available()) {
-    uint8_t byte = Serial.read();
-    PacketManager::ReceivingState res = PacketManager::PacketReceiver::getInstance().handleReceivedByte(_packet, byte);
-    if (res == PacketManager::ReceivingState::RECEIVED) {
-      if (_packet.Type == PacketManager::MessageType::TRANSMISSION_CONTROL) {
-        if (_packet.Payload.len() == 1 && _packet.Payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::CONNECT) {
-          //CONNECT
-          nextState = AgentConfiguratorStates::PEER_CONNECTED;
+  uint8_t chunk[BCP_RECEIVE_CHUNK_SIZE];
+  size_t chunkLen = 0;
+  while ((chunkLen = readBytes(chunk, sizeof(chunk))) > 0) {
+    size_t offset = 0;
+    while (offset < chunkLen || PacketManager::PacketReceiver::getInstance().hasPendingBytes(_packet)) {
+      size_t consumed = 0;
+      PacketManager::ReceivingState res = PacketManager::PacketReceiver::getInstance().handleReceivedChunk(_packet, &chunk[offset], chunkLen - offset, consumed);
+      offset += consumed;
+      if (res == PacketManager::ReceivingState::RECEIVED) {
+        if (_packet.Type == PacketManager::MessageType::TRANSMISSION_CONTROL) {
+          if (_packet.Payload.len() == 1 && _packet.Payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::CONNECT) {
+            //CONNECT, the output of the previous peer still queued is dropped
+            if (_disconnecting) {
+              _disconnecting = false;
+              clear();
+            }
+            nextState = AgentConfiguratorStates::PEER_CONNECTED;
+          }
         }
+        PacketManager::PacketReceiver::getInstance().clear(_packet);
+      } else if (res == PacketManager::ReceivingState::ERROR || res == PacketManager::ReceivingState::INVALID_LENGTH) {
+        DEBUG_DEBUG("SerialAgentClass::%s Error receiving packet", __FUNCTION__);
       }
-      PacketManager::PacketReceiver::getInstance().clear(_packet);
-    } else if (res == PacketManager::ReceivingState::ERROR) {
-      DEBUG_DEBUG("SerialAgentClass::%s Error receiving packet", __FUNCTION__);
-      clearInputBuffer();
     }
   }
 
@@ -180,6 +221,14 @@ inline uint8_t SerialAgentClass::read() {
   return Serial.read();
 }
 
+inline size_t SerialAgentClass::readBytes(uint8_t *data, size_t len) {
+  size_t available = Serial.available();
+  if (available < len) {
+    len = available;
+  }
+  return Serial.readBytes(data, len);
+}
+
 inline int SerialAgentClass::write(const uint8_t *data, size_t len) {
   return Serial.write(data, len);
 }
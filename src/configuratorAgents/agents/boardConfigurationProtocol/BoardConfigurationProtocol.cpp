@@ -15,6 +15,25 @@
 
 #define PACKET_VALIDITY_MS 30000
 
+// Tag and array header, then the pin, the array of up to BAND_SIZE uint32 bands, the apn, the login and the password
+#define CBOR_CATM1_SETTINGS_LEN (CBOR_DATA_HEADER_LEN + PIN_SIZE + 2 + 1 + BAND_SIZE * 5 + APN_SIZE + 2 + LOGIN_SIZE + 2 + PASS_SIZE + 2)
+
+static_assert(BCP_PACKET_POOL_SLOT_SIZE >= CBOR_DATA_JWT_LEN + PACKET_HEADERS_OVERHEAD + PACKET_SEQUENCE_SIZE, "BCP_PACKET_POOL_SLOT_SIZE must fit the JWT packet");
+static_assert(BCP_MAX_FRAME_SIZE >= CBOR_CATM1_SETTINGS_LEN + PACKET_HEADERS_OVERHEAD + PACKET_SEQUENCE_SIZE, "BCP_MAX_FRAME_SIZE must fit the biggest network settings packet");
+static_assert(BCP_PACKET_POOL_SLOT_SIZE >= BCP_MAX_FRAME_SIZE, "BCP_PACKET_POOL_SLOT_SIZE must fit the biggest received packet");
+
+/* The status codes are a closed set and their DATA packets never change, the sequence number is added when they are queued.
+ * The framed packets are cached the first time they are sent and then copied in the inline storage of the PacketBuffer
+ */
+typedef struct {
+  StatusMessage status;
+  uint8_t len;
+  uint8_t frame[PACKET_BUFFER_INLINE_SIZE];
+} StatusFrame;
+
+static StatusFrame statusFrames[BCP_STATUS_FRAME_CACHE_SIZE];
+static uint8_t numStatusFrames = 0;
+
 /******************************************************************************
  * PUBLIC MEMBER FUNCTIONS
  ******************************************************************************/
@@ -22,11 +41,17 @@ bool BoardConfigurationProtocol::getMsg(ProvisioningInputMessage &msg) {
   if (_inputMessagesList.size() == 0) {
     return false;
   }
-  InputPacketBuffer *buf = &_inputMessagesList.front();
-  ProvisioningMessageDown cborMsg;
+  InputPacketBuffer &buf = _inputMessagesList.front();
+  ProvisioningValueMessageDown cborMsg;
+
+  // The network settings are decoded straight into the destination of the receiver
+  bool decodeRes = CBORAdapter::getMsgFromCBOR(buf.get_ptr(), buf.len(), &cborMsg, msg.netSetting);
+  _inputMessagesList.pop();
 
-  bool decodeRes = CBORAdapter::getMsgFromCBOR(buf->get_ptr(), buf->len(), &cborMsg);
-  _inputMessagesList.pop_front();
+  if (!_rxReorderList.empty() && deliverOutOfOrderData()) {
+    //The packets kept waiting for room in the input queue are acknowledged
+    sendAck(_rxSequence - 1);
+  }
 
   if (!decodeRes) {
     DEBUG_DEBUG("BoardConfigurationProtocol::%s Invalid message", __FUNCTION__);
@@ -42,8 +67,6 @@ bool BoardConfigurationProtocol::getMsg(ProvisioningInputMessage &msg) {
     msg.m.cmd = (RemoteCommands)cborMsg.provisioningCommands.cmd;
   } else {
     msg.type = MessageInputType::NETWORK_SETTINGS;
-    msg.m.netSetting.type = NetworkAdapter::NONE;
-    memcpy(&msg.m.netSetting, &cborMsg.provisioningNetworkConfig.networkSetting, sizeof(models::NetworkSetting));
   }
   return true;
 }
@@ -57,6 +80,9 @@ bool BoardConfigurationProtocol::sendMsg(ProvisioningOutputMessage &msg) {
     case MessageOutputType::NETWORK_OPTIONS:
       res = sendNetworkOptions(msg.m.netOptions);
       break;
+    case MessageOutputType::NETWORK_OPTIONS_UPDATE:
+      res = sendNetworkOptions(msg.m.netOptions, true);
+      break;
     case MessageOutputType::UHWID:
       res = sendUhwid(msg.m.uhwid);
       break;
@@ -86,7 +112,16 @@ bool BoardConfigurationProtocol::sendMsg(ProvisioningOutputMessage &msg) {
 }
 
 bool BoardConfigurationProtocol::msgAvailable() {
-  return _inputMessagesList.size() > 0;
+  return !_inputMessagesList.empty();
+}
+
+bool BoardConfigurationProtocol::pendingOutput() {
+  for (size_t i = 0; i < _outputMessagesList.size(); i++) {
+    if (_outputMessagesList[i].hasBytesToSend()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 /******************************************************************************
@@ -98,7 +133,7 @@ BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::sendA
     return TransmissionResult::PEER_NOT_AVAILABLE;
   }
 
-  if (_outputMessagesList.size() > 0) {
+  if (!_outputMessagesList.empty()) {
     checkOutputPacketValidity();
     transmitStream();
   }
@@ -107,19 +142,40 @@ BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::sendA
     return transmissionRes;
   }
 
-  int receivedDataLen = available();
+  uint8_t chunk[BCP_RECEIVE_CHUNK_SIZE];
+  size_t receivedDataLen = available();
 
-  for (int i = 0; i < receivedDataLen; i++) {
-    PacketManager::ReceivingState res;
-    uint8_t val = read();
+  while (receivedDataLen > 0) {
+    size_t chunkLen = readBytes(chunk, receivedDataLen < sizeof(chunk) ? receivedDataLen : sizeof(chunk));
+    if (chunkLen == 0) {
+      break;
+    }
+    receivedDataLen = chunkLen < receivedDataLen ? receivedDataLen - chunkLen : 0;
 
-    res = PacketManager::PacketReceiver::getInstance().handleReceivedByte(_packet, val);
-    if (res == PacketManager::ReceivingState::ERROR) {
+    if (receiveChunk(chunk, chunkLen) == TransmissionResult::DATA_RECEIVED) {
+      transmissionRes = TransmissionResult::DATA_RECEIVED;
+    }
+  }
+
+  return transmissionRes;
+}
+
+BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::receiveChunk(const uint8_t *data, size_t len) {
+  TransmissionResult transmissionRes = TransmissionResult::NOT_COMPLETED;
+  size_t offset = 0;
+  while (offset < len || PacketManager::PacketReceiver::getInstance().hasPendingBytes(_packet)) {
+    size_t consumed = 0;
+    PacketManager::ReceivingState res = PacketManager::PacketReceiver::getInstance().handleReceivedChunk(_packet, &data[offset], len - offset, consumed);
+    offset += consumed;
+
+    if (res == PacketManager::ReceivingState::ERROR || res == PacketManager::ReceivingState::INVALID_LENGTH) {
+      //The receiver scans again the bytes after the rejected start marker, the buffered input is kept
       DEBUG_DEBUG("BoardConfigurationProtocol::%s Malformed packet", __FUNCTION__);
       sendNak();
-      clearInputBuffer();
-      transmissionRes = TransmissionResult::INVALID_DATA;
-      break;
+    } else if (res == PacketManager::ReceivingState::NO_BUFFER) {
+      //The packet is well formed but there is no room for it: it's dropped and the peer sends it again
+      DEBUG_WARNING("BoardConfigurationProtocol::%s Packet pool exhausted, packet discarded", __FUNCTION__);
+      sendNak();
     } else if (res == PacketManager::ReceivingState::RECEIVED) {
       switch (_packet.Type) {
         case PacketManager::MessageType::DATA:
@@ -127,17 +183,33 @@ BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::sendA
             #if BCP_DEBUG_PACKET == 1
             printPacket("payload", _packet.Payload.get_ptr(), _packet.Payload.len());
             #endif
-            _inputMessagesList.push_back(_packet.Payload);
-            //Consider all sent data as received
-            _outputMessagesList.clear();
+            if (!_inputMessagesList.push(std::move(_packet.Payload))) {
+              DEBUG_WARNING("BoardConfigurationProtocol::%s Input queue full, message discarded", __FUNCTION__);
+              PacketManager::PacketReceiver::getInstance().clear(_packet);
+              sendNak();
+              continue;
+            }
+            if (!_selectiveMode) {
+              //Consider all sent data as received, the packets still in transmission are kept
+              while (!_outputMessagesList.empty() && !_outputMessagesList.front().hasBytesToSend()) {
+                _outputMessagesList.pop();
+              }
+            }
+            transmissionRes = TransmissionResult::DATA_RECEIVED;
+          }
+          break;
+        case PacketManager::MessageType::SEQUENCED_DATA:
+          if (handleSequencedData()) {
             transmissionRes = TransmissionResult::DATA_RECEIVED;
           }
           break;
         case PacketManager::MessageType::TRANSMISSION_CONTROL:
           {
-            if (_packet.Payload.len() == 1 && _packet.Payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::NACK) {
-              for (std::list<OutputPacketBuffer>::iterator packet = _outputMessagesList.begin(); packet != _outputMessagesList.end(); ++packet) {
-                packet->startProgress();
+            if (_packet.Payload.len() == 2) {
+              handleSelectiveControl((PacketManager::TransmissionControlMessage)_packet.Payload[0], _packet.Payload[1]);
+            } else if (_packet.Payload.len() == 1 && _packet.Payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::NACK) {
+              for (size_t i = 0; i < _outputMessagesList.size(); i++) {
+                _outputMessagesList[i].startProgress();
               }
             } else if (_packet.Payload.len() == 1 && _packet.Payload[0] == (uint8_t)PacketManager::TransmissionControlMessage::DISCONNECT) {
               handleDisconnectRequest();
@@ -155,51 +227,105 @@ BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::sendA
 }
 
 bool BoardConfigurationProtocol::sendNak() {
+  if (_selectiveMode) {
+    //Ask the peer to resend only the first DATA packet not yet received
+    return sendNak(_rxSequence);
+  }
   uint8_t data = 0x03;
   return sendData(PacketManager::MessageType::TRANSMISSION_CONTROL, &data, sizeof(data));
 }
 
+bool BoardConfigurationProtocol::sendNak(uint8_t seq) {
+  uint8_t data[] = { (uint8_t)PacketManager::TransmissionControlMessage::NACK, seq };
+  return sendData(PacketManager::MessageType::TRANSMISSION_CONTROL, data, sizeof(data));
+}
+
+bool BoardConfigurationProtocol::sendAck(uint8_t seq) {
+  uint8_t data[] = { (uint8_t)PacketManager::TransmissionControlMessage::ACK, seq };
+  return sendData(PacketManager::MessageType::TRANSMISSION_CONTROL, data, sizeof(data));
+}
+
 bool BoardConfigurationProtocol::sendData(PacketManager::MessageType type, const uint8_t *data, size_t len) {
   OutputPacketBuffer outputMsg;
-  outputMsg.setValidityTs(millis() + PACKET_VALIDITY_MS);
 
   if (!PacketManager::createPacket(outputMsg, type, data, len)) {
+    logPacketAllocationError(len);
+    return false;
+  }
+
+  return enqueuePacket(outputMsg, type);
+}
+
+bool BoardConfigurationProtocol::enqueuePacket(OutputPacketBuffer &outputMsg, PacketManager::MessageType type) {
+  if (_outputMessagesList.full() && !_selectiveMode) {
+    //Without the ACKs the packets already sent are kept only for being resent after a NACK,
+    //the oldest one makes room for the new packet
+    bool removed = false;
+    _outputMessagesList.removeIf([&removed](OutputPacketBuffer &packet) {
+      if (removed || packet.hasBytesToSend()) {
+        return false;
+      }
+      removed = true;
+      return true;
+    });
+  }
+
+  if (_outputMessagesList.full()) {
+    DEBUG_WARNING("BoardConfigurationProtocol::%s Output queue full", __FUNCTION__);
     return false;
   }
 
+  outputMsg.setValidityTs(millis() + PACKET_VALIDITY_MS);
+
+  if (type == PacketManager::MessageType::DATA) {
+    outputMsg.setSequence(_txSequence);
+    if (_selectiveMode && !PacketManager::addSequence(outputMsg, _txSequence)) {
+      return false;
+    }
+    _txSequence++;
+  }
+
   #if BCP_DEBUG_PACKET == 1
   printPacket("output message", outputMsg.get_ptr(), outputMsg.len());
   #endif
 
-  _outputMessagesList.push_back(outputMsg);
-
-  TransmissionResult res = TransmissionResult::NOT_COMPLETED;
-  do {
-    res = transmitStream();
-    if (res == TransmissionResult::PEER_NOT_AVAILABLE) {
-      break;
-    }
-  } while (res == TransmissionResult::NOT_COMPLETED);
+  //The packet is transmitted by the following calls of sendAndReceive()
+  _outputMessagesList.push(std::move(outputMsg));
 
   return true;
 }
 
+void BoardConfigurationProtocol::drainOutput(uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (transmitStream() == TransmissionResult::NOT_COMPLETED && millis() - start < timeoutMs) {
+  }
+}
+
+void BoardConfigurationProtocol::clearInput() {
+  PacketManager::PacketReceiver::getInstance().reset(_packet);
+  _inputMessagesList.clear();
+  _rxReorderList.clear();
+}
+
 void BoardConfigurationProtocol::clear() {
-  PacketManager::PacketReceiver::getInstance().clear(_packet);
+  clearInput();
   _outputMessagesList.clear();
-  _inputMessagesList.clear();
+  _txSequence = 0;
+  _rxSequence = 0;
+  _rxAheadSequence = 0;
+  _rxGap = false;
+  _selectiveMode = false;
 }
 
 void BoardConfigurationProtocol::checkOutputPacketValidity() {
-  if (_outputMessagesList.size() == 0) {
-    return;
-  }
-  _outputMessagesList.remove_if([](OutputPacketBuffer &packet) {
-    if (packet.getValidityTs() != 0 && packet.getValidityTs() < millis()) {
-      return true;
+  // All the packets have the same validity period, so they expire in the order they were enqueued
+  while (!_outputMessagesList.empty()) {
+    uint32_t validityTs = _outputMessagesList.front().getValidityTs();
+    if (validityTs == 0 || validityTs >= millis()) {
+      break;
     }
-    return false;
-  });
+    _outputMessagesList.pop();
+  }
 }
 
 /******************************************************************************
@@ -207,14 +333,33 @@ void BoardConfigurationProtocol::checkOutputPacketValidity() {
  ******************************************************************************/
 bool BoardConfigurationProtocol::sendStatus(StatusMessage msg) {
   bool res = false;
-  size_t len = CBOR_DATA_STATUS_LEN;
-  uint8_t data[len];
-  res = CBORAdapter::statusToCBOR(msg, data, &len);
+  OutputPacketBuffer outputMsg;
+
+  for (uint8_t i = 0; i < numStatusFrames; i++) {
+    if (statusFrames[i].status == msg) {
+      res = outputMsg.allocate(statusFrames[i].len + PACKET_SEQUENCE_SIZE) && outputMsg.copyArray(statusFrames[i].frame, statusFrames[i].len);
+      break;
+    }
+  }
+
   if (!res) {
-    return res;
+    size_t len = CBOR_DATA_STATUS_LEN;
+    uint8_t data[len];
+    if (!CBORAdapter::statusToCBOR(msg, data, &len) ||
+        !PacketManager::createPacket(outputMsg, PacketManager::MessageType::DATA, data, len)) {
+      return false;
+    }
+
+    if (numStatusFrames < BCP_STATUS_FRAME_CACHE_SIZE && outputMsg.len() <= PACKET_BUFFER_INLINE_SIZE) {
+      StatusFrame &statusFrame = statusFrames[numStatusFrames++];
+      statusFrame.status = msg;
+      statusFrame.len = outputMsg.len();
+      memcpy(statusFrame.frame, outputMsg.get_ptr(), outputMsg.len());
+    }
   }
 
-  res = sendData(PacketManager::MessageType::DATA, data, len);
+  outputMsg.startProgress();
+  res = enqueuePacket(outputMsg, PacketManager::MessageType::DATA);
   if (!res) {
     DEBUG_WARNING("BoardConfigurationProtocol::%s failed to send status: %d ", __FUNCTION__, (int)msg);
   }
@@ -234,17 +379,30 @@ size_t BoardConfigurationProtocol::calculateTotalOptionsLength(const NetworkOpti
   return length;
 }
 
-bool BoardConfigurationProtocol::sendNetworkOptions(const NetworkOptions *netOptions) {
+bool BoardConfigurationProtocol::sendNetworkOptions(const NetworkOptions *netOptions, bool update) {
   bool res = false;
 
+  // The list is the biggest message, it's encoded directly in the payload of the packet
   size_t len = calculateTotalOptionsLength(netOptions);
-  uint8_t data[len];
+  OutputPacketBuffer outputMsg;
+  uint8_t *data = PacketManager::reservePacket(outputMsg, len);
+  if (data == nullptr) {
+    logPacketAllocationError(len);
+    return res;
+  }
+
+  if (update) {
+    res = CBORAdapter::networkOptionsUpdateToCBOR(netOptions, data, &len);
+  } else {
+    res = CBORAdapter::networkOptionsToCBOR(netOptions, data, &len);
+  }
 
-  if (!CBORAdapter::networkOptionsToCBOR(netOptions, data, &len)) {
+  if (!res) {
     return res;
   }
 
-  res = sendData(PacketManager::MessageType::DATA, data, len);
+  res = PacketManager::finalizePacket(outputMsg, PacketManager::MessageType::DATA, len) &&
+        enqueuePacket(outputMsg, PacketManager::MessageType::DATA);
   if (!res) {
     DEBUG_WARNING("BoardConfigurationProtocol::%s failed to send network options", __FUNCTION__);
   }
@@ -363,20 +521,38 @@ bool BoardConfigurationProtocol::sendVersion(const char *version, MessageOutputT
 }
 
 BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::transmitStream() {
-  if (!isPeerConnected()) {
-    return TransmissionResult::PEER_NOT_AVAILABLE;
-  }
-
-  if (_outputMessagesList.size() == 0) {
+  if (_outputMessagesList.empty()) {
     return TransmissionResult::COMPLETED;
   }
 
   TransmissionResult res = TransmissionResult::COMPLETED;
 
-  for (std::list<OutputPacketBuffer>::iterator packet = _outputMessagesList.begin(); packet != _outputMessagesList.end(); ++packet) {
+  //In selective mode the control packets are never resent, the ones already sent are removed
+  //even if they follow a DATA packet waiting for its ACK
+  if (_selectiveMode) {
+    _outputMessagesList.removeIf([](OutputPacketBuffer &packet) {
+      return !packet.hasSequence() && !packet.hasBytesToSend();
+    });
+  }
+
+  size_t inFlight = 0;
+  for (size_t i = 0; i < _outputMessagesList.size(); i++) {
+    OutputPacketBuffer *packet = &_outputMessagesList[i];
+    if (_selectiveMode && packet->hasSequence()) {
+      //The DATA packets in the queue are not yet acknowledged, only the first BCP_SEND_WINDOW can be sent
+      if (inFlight >= BCP_SEND_WINDOW) {
+        continue;
+      }
+      inFlight++;
+    }
     if (packet->hasBytesToSend()) {
       res = TransmissionResult::NOT_COMPLETED;
-      packet->incrementBytesSent(write(packet->get_ptrAt(packet->bytesSent()), packet->bytesToSend()));
+      int written = write(packet->get_ptrAt(packet->bytesSent()), packet->bytesToSend());
+      if (written <= 0) {
+        break;
+      }
+      packet->incrementBytesSent(written);
+      handleTransmissionProgress(packet->bytesSent(), packet->len());
       #if BCP_DEBUG_PACKET == 1
       DEBUG_DEBUG("BoardConfigurationProtocol::%s  transferred: %d of %d", __FUNCTION__, packet->bytesSent(), packet->len());
       #endif
@@ -387,6 +563,146 @@ BoardConfigurationProtocol::TransmissionResult BoardConfigurationProtocol::trans
   return res;
 }
 
+void BoardConfigurationProtocol::enableSelectiveMode() {
+  if (_selectiveMode) {
+    return;
+  }
+
+  //The queued data packets are sent again with their sequence number, the peer discards the ones already received
+  _selectiveMode = true;
+  for (size_t i = 0; i < _outputMessagesList.size(); i++) {
+    OutputPacketBuffer &packet = _outputMessagesList[i];
+    if (packet.hasSequence()) {
+      PacketManager::addSequence(packet, packet.getSequence());
+    }
+  }
+}
+
+bool BoardConfigurationProtocol::handleSequencedData() {
+  if (_packet.Payload.len() < PACKET_SEQUENCE_SIZE) {
+    return false;
+  }
+
+  enableSelectiveMode();
+  uint8_t seq = _packet.Payload[0];
+  uint8_t distance = seq - _rxSequence;
+
+  if (distance >= 128) {
+    //Resent by the peer but already received, the ACK is repeated in case it was lost
+    sendAck(_rxSequence - 1);
+    return false;
+  }
+
+  if (distance > 0) {
+    storeOutOfOrderData(seq, distance);
+    return false;
+  }
+
+  _packet.Payload.discardFront(PACKET_SEQUENCE_SIZE);
+  #if BCP_DEBUG_PACKET == 1
+  printPacket("payload", _packet.Payload.get_ptr(), _packet.Payload.len());
+  #endif
+  if (!_inputMessagesList.push(std::move(_packet.Payload))) {
+    DEBUG_WARNING("BoardConfigurationProtocol::%s Input queue full, message discarded", __FUNCTION__);
+    sendNak();
+    return false;
+  }
+
+  _rxSequence++;
+  deliverOutOfOrderData();
+  //The ACK is cumulative, a single one acknowledges also the packets received after the missing one
+  sendAck(_rxSequence - 1);
+  return true;
+}
+
+void BoardConfigurationProtocol::storeOutOfOrderData(uint8_t seq, uint8_t distance) {
+  if (distance >= BCP_SEND_WINDOW) {
+    DEBUG_DEBUG("BoardConfigurationProtocol::%s Packet %d out of the window, discarded", __FUNCTION__, seq);
+    return;
+  }
+
+  for (size_t i = 0; i < _rxReorderList.size(); i++) {
+    if (_rxReorderList[i][0] == seq) {
+      return;
+    }
+  }
+
+  //Only the packets missing between the highest received and this one are requested, each one once
+  if (!_rxGap || (uint8_t)(seq - _rxAheadSequence) < 128) {
+    for (uint8_t missing = _rxGap ? _rxAheadSequence + 1 : _rxSequence; missing != seq; missing++) {
+      sendNak(missing);
+    }
+    _rxAheadSequence = seq;
+    _rxGap = true;
+  }
+
+  //The sequence number is kept in front of the payload until the packet is delivered
+  if (!_rxReorderList.push(std::move(_packet.Payload))) {
+    DEBUG_WARNING("BoardConfigurationProtocol::%s Reorder queue full, packet %d discarded", __FUNCTION__, seq);
+  }
+}
+
+bool BoardConfigurationProtocol::deliverOutOfOrderData() {
+  bool delivered = false;
+  while (!_inputMessagesList.full()) {
+    size_t idx = 0;
+    while (idx < _rxReorderList.size() && _rxReorderList[idx][0] != _rxSequence) {
+      idx++;
+    }
+    if (idx == _rxReorderList.size()) {
+      break;
+    }
+
+    InputPacketBuffer &packet = _rxReorderList[idx];
+    packet.discardFront(PACKET_SEQUENCE_SIZE);
+    #if BCP_DEBUG_PACKET == 1
+    printPacket("payload", packet.get_ptr(), packet.len());
+    #endif
+    _inputMessagesList.push(std::move(packet));
+    _rxReorderList.removeIf([](InputPacketBuffer &p) {
+      return p.len() == 0;
+    });
+    _rxSequence++;
+    delivered = true;
+  }
+
+  if (_rxGap && (uint8_t)(_rxAheadSequence - _rxSequence) >= 128) {
+    _rxGap = false;
+  }
+  return delivered;
+}
+
+void BoardConfigurationProtocol::handleSelectiveControl(PacketManager::TransmissionControlMessage msg, uint8_t seq) {
+  enableSelectiveMode();
+
+  if (msg == PacketManager::TransmissionControlMessage::ACK) {
+    //The ACK is cumulative, the acknowledged packets and the control packets already sent are removed
+    while (!_outputMessagesList.empty()) {
+      OutputPacketBuffer &packet = _outputMessagesList.front();
+      if (packet.hasSequence() ? (uint8_t)(seq - packet.getSequence()) >= 128 : packet.hasBytesToSend()) {
+        break;
+      }
+      _outputMessagesList.pop();
+    }
+  } else if (msg == PacketManager::TransmissionControlMessage::NACK) {
+    for (size_t i = 0; i < _outputMessagesList.size(); i++) {
+      OutputPacketBuffer &packet = _outputMessagesList[i];
+      if (packet.hasSequence() && packet.getSequence() == seq) {
+        packet.startProgress();
+        break;
+      }
+    }
+  }
+}
+
+void BoardConfigurationProtocol::logPacketAllocationError(size_t len) {
+  if (PacketPool::getInstance().freeSlots(len + PACKET_HEADERS_OVERHEAD) == 0) {
+    DEBUG_WARNING("BoardConfigurationProtocol::%s Packet pool exhausted, packet of %d bytes not sent", __FUNCTION__, (int)len);
+  } else {
+    DEBUG_WARNING("BoardConfigurationProtocol::%s failed to create a packet of %d bytes", __FUNCTION__, (int)len);
+  }
+}
+
 void BoardConfigurationProtocol::printPacket(const char *label, const uint8_t *data, size_t len) {
   if (Debug.getDebugLevel() == DBG_VERBOSE) {
     DEBUG_VERBOSE("Print %s data:", label);
@@ -7,10 +7,14 @@
 */
 
 #pragma once
-#include <list>
+#include "ANetworkConfigurator_Config.h"
 #include "PacketManager.h"
+#include "PacketQueue.h"
 #include "configuratorAgents/MessagesDefinitions.h"
 
+// The peer sends at most BCP_SEND_WINDOW packets ahead of the first one not yet acknowledged
+#define BCP_RX_REORDER_DEPTH (BCP_SEND_WINDOW > 1 ? BCP_SEND_WINDOW - 1 : 1)
+
 /**
  * @class BoardConfigurationProtocol
  * @brief Abstract class that implements the ArduinoBoardConfiguration Protocol for board
@@ -41,6 +45,12 @@ public:
    */
   bool msgAvailable();
 
+  /**
+   * @brief Checks if the queued messages have bytes still to write.
+   * @return True if a queued message has not been completely written yet, false otherwise.
+   */
+  bool pendingOutput();
+
 protected:
   enum class TransmissionResult { INVALID_DATA = -2,
                                   PEER_NOT_AVAILABLE = -1,
@@ -48,10 +58,43 @@ protected:
                                   COMPLETED = 1,
                                   DATA_RECEIVED = 2 };
   TransmissionResult sendAndReceive();
+  /**
+   * @brief Writes the next part of the output queue, it doesn't check the peer connection.
+   * The agents call it once per update also while disconnecting, to send the DISCONNECT message.
+   * @return NOT_COMPLETED if there are bytes still to write, COMPLETED otherwise.
+   */
+  TransmissionResult transmitStream();
+  /**
+   * @brief Parses a chunk of received bytes, the complete packets are handled as soon as they are found.
+   * Used by sendAndReceive() and by the agents that get the received bytes from an event instead of reading them.
+   * @param data Pointer to the received bytes.
+   * @param len Number of received bytes.
+   * @return DATA_RECEIVED if a message has been queued, NOT_COMPLETED otherwise.
+   */
+  TransmissionResult receiveChunk(const uint8_t *data, size_t len);
   bool sendNak();
+  bool sendNak(uint8_t seq);
+  bool sendAck(uint8_t seq);
   bool sendData(PacketManager::MessageType type, const uint8_t *data, size_t len);
+  // Queues a packet built in place with PacketManager::reservePacket() and finalizePacket()
+  bool enqueuePacket(OutputPacketBuffer &outputMsg, PacketManager::MessageType type);
+  /**
+   * @brief Writes the output queue blocking for up to timeoutMs.
+   * Only for the teardown in end(), when the agent won't be updated anymore: a disconnection
+   * requested while the agent is running is completed by the following calls of transmitStream().
+   */
+  void drainOutput(uint32_t timeoutMs);
+  // Drops the received bytes and messages, the output queue is kept
+  void clearInput();
   void clear();
   void checkOutputPacketValidity();
+  /**
+   * @brief Called every time a part of an output packet is written to the physical interface.
+   * The packet has been completely transmitted when sent is equal to total.
+   * @param sent Number of bytes of the packet transmitted so far.
+   * @param total Size of the packet.
+   */
+  virtual void handleTransmissionProgress(size_t /*sent*/, size_t /*total*/) {};
   /*Pure virtual methods that depends on physical interface*/
 
   /**
@@ -69,6 +112,13 @@ protected:
    * @return The read byte.
    */
   virtual uint8_t read() = 0;
+  /**
+   * @brief Reads a chunk of bytes from the physical interface input buffer.
+   * @param data Pointer to the buffer where the read bytes are stored.
+   * @param len Maximum number of bytes to read.
+   * @return The number of bytes read.
+   */
+  virtual size_t readBytes(uint8_t *data, size_t len) = 0;
   /**
    * @brief Writes data to the physical interface output buffer.
    * @param data Pointer to the data to write.
@@ -93,15 +143,27 @@ protected:
 private:
   bool sendStatus(StatusMessage msg);
   size_t calculateTotalOptionsLength(const NetworkOptions *netOptions);
-  bool sendNetworkOptions(const NetworkOptions *netOptions);
+  bool sendNetworkOptions(const NetworkOptions *netOptions, bool update = false);
   bool sendUhwid(const byte *uhwid);
   bool sendJwt(const char *jwt, size_t len);
   bool sendProvPublicKey(const char *provPublicKey, size_t len);
   bool sendBleMacAddress(const uint8_t *mac, size_t len);
   bool sendVersion(const char *version, MessageOutputType type);
-  TransmissionResult transmitStream();
+  void enableSelectiveMode();
+  bool handleSequencedData();
+  void storeOutOfOrderData(uint8_t seq, uint8_t distance);
+  bool deliverOutOfOrderData();
+  void handleSelectiveControl(PacketManager::TransmissionControlMessage msg, uint8_t seq);
+  void logPacketAllocationError(size_t len);
   void printPacket(const char *label, const uint8_t *data, size_t len);
-  std::list<OutputPacketBuffer> _outputMessagesList;
-  std::list<InputPacketBuffer> _inputMessagesList;
+  PacketQueue<OutputPacketBuffer, BCP_OUTPUT_QUEUE_DEPTH> _outputMessagesList;
+  PacketQueue<InputPacketBuffer, BCP_INPUT_QUEUE_DEPTH> _inputMessagesList;
+  // Sequenced packets received after a missing one, kept with their sequence number until it's received
+  PacketQueue<InputPacketBuffer, BCP_RX_REORDER_DEPTH> _rxReorderList;
   PacketManager::Packet_t _packet;
+  uint8_t _txSequence = 0;
+  uint8_t _rxSequence = 0;
+  uint8_t _rxAheadSequence = 0; // The highest sequence number received after a missing packet
+  bool _rxGap = false;
+  bool _selectiveMode = false;
 };
@@ -10,26 +10,52 @@
 
 #include "CBORAdapter.h"
 #include "cbor/MessageEncoder.h"
-#include "cbor/MessageDecoder.h"
+#include "cbor/ProvisioningMessageDecoder.h"
+
+/* The messages with a fixed shape are built copying their precomputed CBOR skeleton: tag and array(1),
+ * then only the variable field is written in place without walking the generic encoder
+ */
+#define CBOR_TAG_BYTES(tag) 0xda, (uint8_t)((tag) >> 24), (uint8_t)((tag) >> 16), (uint8_t)((tag) >> 8), (uint8_t)(tag)
+#define CBOR_ARRAY_1 0x81
+#define CBOR_UNSIGNED_INT 0x00
+#define CBOR_NEGATIVE_INT 0x20
+#define CBOR_BYTE_STRING 0x40
+#define CBOR_TEXT_STRING 0x60
+
+static constexpr uint8_t CBOR_STATUS_TEMPLATE[]                = { CBOR_TAG_BYTES(CBORStatusProvisioningMessage), CBOR_ARRAY_1 };
+static constexpr uint8_t CBOR_UHWID_TEMPLATE[]                 = { CBOR_TAG_BYTES(CBORUniqueHardwareIdProvisioningMessage), CBOR_ARRAY_1, CBOR_BYTE_STRING | 24, MAX_UHWID_SIZE };
+static constexpr uint8_t CBOR_BLE_MAC_TEMPLATE[]               = { CBOR_TAG_BYTES(CBORBLEMacAddressProvisioningMessage), CBOR_ARRAY_1 };
+static constexpr uint8_t CBOR_PROV_SKETCH_VERSION_TEMPLATE[]   = { CBOR_TAG_BYTES(CBORProvSketchVersionProvisioningMessage), CBOR_ARRAY_1 };
+static constexpr uint8_t CBOR_NETCONFIG_LIB_VERSION_TEMPLATE[] = { CBOR_TAG_BYTES(CBORNetConfigLibVersProvisioningMessage), CBOR_ARRAY_1 };
+
+// Writes the header of a CBOR item, returns the number of bytes written (up to 3)
+static size_t writeCBORHeader(uint8_t majorType, uint16_t arg, uint8_t *data) {
+  if (arg < 24) {
+    data[0] = majorType | arg;
+    return 1;
+  }
+  if (arg <= 0xff) {
+    data[0] = majorType | 24;
+    data[1] = arg;
+    return 2;
+  }
+  data[0] = majorType | 25;
+  data[1] = arg >> 8;
+  data[2] = arg & 0xff;
+  return 3;
+}
 
 bool CBORAdapter::uhwidToCBOR(const byte *uhwid, uint8_t *data, size_t *len) {
-  CBORMessageEncoder encoder;
-
   if (*len < CBOR_DATA_UHWID_LEN) {
     return false;
   }
 
-  memset(data, 0x00, *len);
-
-  UniqueHardwareIdProvisioningMessage uhwidMsg;
-  uhwidMsg.c.id = ProvisioningMessageId::UniqueHardwareIdProvisioningMessageId;
-  memset(uhwidMsg.uniqueHardwareId, 0x00, MAX_UHWID_SIZE);
+  memcpy(data, CBOR_UHWID_TEMPLATE, sizeof(CBOR_UHWID_TEMPLATE));
   //Since some bytes of UHWID could be 00 is not possible use strlen to copy the UHWID
-  memcpy(uhwidMsg.uniqueHardwareId, uhwid, MAX_UHWID_SIZE);
-
-  MessageEncoder::Status status = encoder.encode((Message *)&uhwidMsg, data, *len);
+  memcpy(&data[sizeof(CBOR_UHWID_TEMPLATE)], uhwid, MAX_UHWID_SIZE);
+  *len = sizeof(CBOR_UHWID_TEMPLATE) + MAX_UHWID_SIZE;
 
-  return status == MessageEncoder::Status::Complete ? true : false;
+  return true;
 }
 
 bool CBORAdapter::jwtToCBOR(const char *jwt, uint8_t *data, size_t *len) {
@@ -52,20 +78,24 @@ bool CBORAdapter::jwtToCBOR(const char *jwt, uint8_t *data, size_t *len) {
 }
 
 bool CBORAdapter::BLEMacAddressToCBOR(const uint8_t *mac, uint8_t *data, size_t *len) {
-  CBORMessageEncoder encoder;
   if (*len < CBOR_DATA_BLE_MAC_LEN) {
     return false;
   }
 
-  memset(data, 0x00, *len);
-
-  BLEMacAddressProvisioningMessage bleMacMsg;
-  bleMacMsg.c.id = ProvisioningMessageId::BLEMacAddressProvisioningMessageId;
-  memcpy(bleMacMsg.macAddress, mac, BLE_MAC_ADDRESS_SIZE);
+  //An empty MAC address is sent as an empty byte string
+  uint8_t size = 0;
+  uint8_t emptyMac[] = {0, 0, 0, 0, 0, 0};
+  if (memcmp(mac, emptyMac, BLE_MAC_ADDRESS_SIZE) != 0) {
+    size = BLE_MAC_ADDRESS_SIZE;
+  }
 
-  MessageEncoder::Status status = encoder.encode((Message *)&bleMacMsg, data, *len);
+  size_t pos = sizeof(CBOR_BLE_MAC_TEMPLATE);
+  memcpy(data, CBOR_BLE_MAC_TEMPLATE, pos);
+  pos += writeCBORHeader(CBOR_BYTE_STRING, size, &data[pos]);
+  memcpy(&data[pos], mac, size);
+  *len = pos + size;
 
-  return status == MessageEncoder::Status::Complete ? true : false;
+  return true;
 }
 
 bool CBORAdapter::provPublicKeyToCBOR(const char *provPublicKey, uint8_t *data, size_t *len) {
@@ -111,31 +141,11 @@ bool CBORAdapter::wifiFWVersionToCBOR(const char *wifiFWVersion, uint8_t *data,
 }
 
 bool CBORAdapter::provSketchVersionToCBOR(const char *provSketchVersion, uint8_t *data, size_t *len) {
-  CBORMessageEncoder encoder;
-  if(*len < CBOR_MIN_PROV_SKETCH_VERSION_LEN + strlen(provSketchVersion)) {
-    return false;
-  }
-  ProvSketchVersionProvisioningMessage provSketchVersionMsg;
-  provSketchVersionMsg.c.id = ProvisioningMessageId::ProvSketchVersionProvisioningMessageId;
-  provSketchVersionMsg.provSketchVersion = provSketchVersion;
-
-  MessageEncoder::Status status = encoder.encode((Message *)&provSketchVersionMsg, data, *len);
-
-  return status == MessageEncoder::Status::Complete ? true : false;
+  return adaptVersion(CBOR_PROV_SKETCH_VERSION_TEMPLATE, sizeof(CBOR_PROV_SKETCH_VERSION_TEMPLATE), provSketchVersion, data, len);
 }
 
 bool CBORAdapter::netConfigLibVersionToCBOR(const char *netConfigLibVersion, uint8_t *data, size_t *len) {
-  CBORMessageEncoder encoder;
-  if(*len < CBOR_MIN_NETCONFIG_LIB_VERSION_LEN + strlen(netConfigLibVersion)) {
-    return false;
-  }
-  NetConfigLibVersionProvisioningMessage netConfigLibVersionMsg;
-  netConfigLibVersionMsg.c.id = ProvisioningMessageId::NetConfigLibVersProvisioningMessageId;
-  netConfigLibVersionMsg.netConfigLibVersion = netConfigLibVersion;
-
-  MessageEncoder::Status status = encoder.encode((Message *)&netConfigLibVersionMsg, data, *len);
-
-  return status == MessageEncoder::Status::Complete ? true : false;
+  return adaptVersion(CBOR_NETCONFIG_LIB_VERSION_TEMPLATE, sizeof(CBOR_NETCONFIG_LIB_VERSION_TEMPLATE), netConfigLibVersion, data, len);
 }
 
 bool CBORAdapter::networkOptionsToCBOR(const NetworkOptions *netOptions, uint8_t *data, size_t *len) {
@@ -153,33 +163,62 @@ bool CBORAdapter::networkOptionsToCBOR(const NetworkOptions *netOptions, uint8_t
   return result;
 }
 
+bool CBORAdapter::networkOptionsUpdateToCBOR(const NetworkOptions *netOptionsUpdate, uint8_t *data, size_t *len) {
+  if (netOptionsUpdate->type != NetworkOptionsClass::WIFI) {
+    return false;
+  }
+  return adaptWiFiOptions(&(netOptionsUpdate->option.wifi), data, len, true);
+}
+
 bool CBORAdapter::getMsgFromCBOR(const uint8_t *data, size_t len, ProvisioningMessageDown *msg) {
-  CBORMessageDecoder decoder;
-  MessageDecoder::Status status = decoder.decode((Message *)msg, data, len);
+  MessageDecoder::Status status = ProvisioningMessageDecoder::decode(msg, data, len);
   return status == MessageDecoder::Status::Complete ? true : false;
 }
 
-bool CBORAdapter::adaptStatus(StatusMessage msg, uint8_t *data, size_t *len) {
-  CBORMessageEncoder encoder;
+bool CBORAdapter::getMsgFromCBOR(const uint8_t *data, size_t len, ProvisioningValueMessageDown *msg, models::NetworkSetting *netSetting) {
+  MessageDecoder::Status status = ProvisioningMessageDecoder::decode(msg, netSetting, data, len);
+  return status == MessageDecoder::Status::Complete ? true : false;
+}
 
+bool CBORAdapter::adaptStatus(StatusMessage msg, uint8_t *data, size_t *len) {
   if (*len < CBOR_DATA_STATUS_LEN) {
     return false;
   }
 
-  StatusProvisioningMessage statusMsg;
-  statusMsg.c.id = ProvisioningMessageId::StatusProvisioningMessageId;
-  statusMsg.status = (int)msg;
+  int16_t status = (int16_t)msg;
+  size_t pos = sizeof(CBOR_STATUS_TEMPLATE);
+  memcpy(data, CBOR_STATUS_TEMPLATE, pos);
+  if (status < 0) {
+    pos += writeCBORHeader(CBOR_NEGATIVE_INT, -1 - status, &data[pos]);
+  } else {
+    pos += writeCBORHeader(CBOR_UNSIGNED_INT, status, &data[pos]);
+  }
+  *len = pos;
+
+  return true;
+}
 
-  MessageEncoder::Status status = encoder.encode((Message *)&statusMsg, data, *len);
+bool CBORAdapter::adaptVersion(const uint8_t *cborTemplate, size_t templateLen, const char *version, uint8_t *data, size_t *len) {
+  size_t versionLen = strlen(version);
+  size_t headerLen = versionLen < 24 ? 1 : versionLen <= 0xff ? 2 : 3;
+  if (versionLen > 0xffff || *len < templateLen + headerLen + versionLen) {
+    return false;
+  }
 
-  return status == MessageEncoder::Status::Complete ? true : false;
+  size_t pos = templateLen;
+  memcpy(data, cborTemplate, pos);
+  pos += writeCBORHeader(CBOR_TEXT_STRING, versionLen, &data[pos]);
+  memcpy(&data[pos], version, versionLen);
+  *len = pos + versionLen;
+
+  return true;
 }
 
-bool CBORAdapter::adaptWiFiOptions(const WiFiOption *wifiOptions, uint8_t *data, size_t *len) {
+bool CBORAdapter::adaptWiFiOptions(const WiFiOption *wifiOptions, uint8_t *data, size_t *len, bool update) {
   CBORMessageEncoder encoder;
 
   ListWifiNetworksProvisioningMessage wifiMsg;
-  wifiMsg.c.id = ProvisioningMessageId::ListWifiNetworksProvisioningMessageId;
+  wifiMsg.c.id = update ? ProvisioningMessageId::WifiNetworksUpdateProvisioningMessageId : ProvisioningMessageId::ListWifiNetworksProvisioningMessageId;
   wifiMsg.numDiscoveredWiFiNetworks = wifiOptions->numDiscoveredWiFiNetworks;
   for (uint8_t i = 0; i < wifiOptions->numDiscoveredWiFiNetworks; i++) {
     wifiMsg.discoveredWifiNetworks[i].SSID = wifiOptions->discoveredWifiNetworks[i].SSID;
@@ -34,9 +34,12 @@ public:
   static bool netConfigLibVersionToCBOR(const char *netConfigLibVersion, uint8_t *data, size_t *len);
   static bool statusToCBOR(StatusMessage msg, uint8_t *data, size_t *len);
   static bool networkOptionsToCBOR(const NetworkOptions *netOptions, uint8_t *data, size_t *len);
+  static bool networkOptionsUpdateToCBOR(const NetworkOptions *netOptionsUpdate, uint8_t *data, size_t *len);
   static bool getMsgFromCBOR(const uint8_t *data, size_t len, ProvisioningMessageDown *msg);
+  static bool getMsgFromCBOR(const uint8_t *data, size_t len, ProvisioningValueMessageDown *msg, models::NetworkSetting *netSetting);
 private:
   CBORAdapter();
   static bool adaptStatus(StatusMessage msg, uint8_t *data, size_t *len);
-  static bool adaptWiFiOptions(const WiFiOption *wifiOptions, uint8_t *data, size_t *len);
+  static bool adaptVersion(const uint8_t *cborTemplate, size_t templateLen, const char *version, uint8_t *data, size_t *len);
+  static bool adaptWiFiOptions(const WiFiOption *wifiOptions, uint8_t *data, size_t *len, bool update = false);
 };
@@ -8,19 +8,22 @@
 
 #pragma once
 #include "Arduino.h"
-#include <memory>
+#include "PacketPool.h"
+
+// Packets up to this size are stored inside the PacketBuffer object without using the PacketPool
+#define PACKET_BUFFER_INLINE_SIZE 24
 
 class PacketBuffer {
 public:
   PacketBuffer(){};
-  PacketBuffer(const PacketBuffer &obj)
-    : _bytesTransferred(obj._bytesTransferred),
-      _bytesToTransfer(obj._bytesToTransfer),
-      _validityTs(obj._validityTs) {
-    allocate(obj._size);
-    memcpy(_buffer.get(), obj._buffer.get(), obj._size);
-  };
-  virtual ~PacketBuffer() = default;
+  // The buffer is owned by a single object, use std::move for transferring it
+  PacketBuffer(const PacketBuffer &obj) = delete;
+  PacketBuffer(PacketBuffer &&obj) {
+    moveFrom(obj);
+  };
+  virtual ~PacketBuffer() {
+    release();
+  };
   void setValidityTs(uint32_t ts) {
     _validityTs = ts;
   };
@@ -33,7 +36,7 @@ public:
   }
   //Return the pointer to the internal buffer. Do not use this method to modify the buffer, only for reading
   const uint8_t *get_ptr(){
-    return _buffer.get();
+    return _buffer;
   }
   //Operator overloaded for reading and updating the value a single byte of the buffer
   uint8_t &operator[](size_t idx) {
@@ -45,24 +48,32 @@ public:
   //Copy the srcBuf at the indicated position of the internal buffer
   virtual bool copyArray(int positionFrom, const uint8_t *srcBuf, size_t len) = 0;
 
-  PacketBuffer &operator=(const PacketBuffer &msg) {
-    _bytesTransferred = msg._bytesTransferred;
-    _bytesToTransfer = msg._bytesToTransfer;
-    _validityTs = msg._validityTs;
-    allocate(msg._size);
-    memcpy(_buffer.get(), msg._buffer.get(), msg._size);
+  PacketBuffer &operator=(const PacketBuffer &msg) = delete;
+  PacketBuffer &operator=(PacketBuffer &&msg) {
+    if (this != &msg) {
+      release();
+      moveFrom(msg);
+    }
+    return *this;
   }
 
-  void allocate(size_t n) {
-    _buffer = std::unique_ptr<uint8_t[]>(new uint8_t[n]);
+  //Reserve n bytes from the inline storage or from the PacketPool. Return false if the PacketPool is exhausted
+  bool allocate(size_t n) {
+    release();
+    if (n <= sizeof(_inlineBuffer)) {
+      _buffer = _inlineBuffer;
+    } else {
+      _buffer = PacketPool::getInstance().acquire(n);
+      if (_buffer == nullptr) {
+        return false;
+      }
+    }
     _size = n;
+    return true;
   }
 
   void reset() {
-    if (_buffer) {
-      _buffer.reset();
-    }
-    _size = 0;
+    release();
     _bytesTransferred = 0;
     _bytesToTransfer = 0;
     _validityTs = 0;
@@ -90,6 +101,9 @@ protected:
   size_t size() {
     return _size;
   };
+  uint8_t *buffer_ptr() {
+    return _buffer;
+  };
   bool setBytes(int position, uint8_t *newChar, size_t len) {
     if (position + len <= _size) {
       memcpy(&_buffer[position], newChar, len);
@@ -99,11 +113,38 @@ protected:
   }
 
 private:
-  std::unique_ptr<uint8_t[]> _buffer;
+  uint8_t *_buffer = nullptr;
+  uint8_t _inlineBuffer[PACKET_BUFFER_INLINE_SIZE];
   size_t _size = 0;
   uint32_t _bytesTransferred = 0;
   uint32_t _bytesToTransfer = 0;
   uint32_t _validityTs = 0;
+
+  void release() {
+    if (_buffer != nullptr && _buffer != _inlineBuffer) {
+      PacketPool::getInstance().release(_buffer);
+    }
+    _buffer = nullptr;
+    _size = 0;
+  }
+
+  void moveFrom(PacketBuffer &obj) {
+    if (obj._buffer == obj._inlineBuffer) {
+      memcpy(_inlineBuffer, obj._inlineBuffer, obj._size);
+      _buffer = _inlineBuffer;
+    } else {
+      _buffer = obj._buffer;
+    }
+    _size = obj._size;
+    _bytesTransferred = obj._bytesTransferred;
+    _bytesToTransfer = obj._bytesToTransfer;
+    _validityTs = obj._validityTs;
+    obj._buffer = nullptr;
+    obj._size = 0;
+    obj._bytesTransferred = 0;
+    obj._bytesToTransfer = 0;
+    obj._validityTs = 0;
+  }
 };
 
 class OutputPacketBuffer : public PacketBuffer {
@@ -133,17 +174,41 @@ public:
   void clear() {
     setBytesTransferred(0);
   };
+  //Return the pointer to the internal buffer at specified index for writing the bytes in place, nullptr if out of bounds
+  uint8_t *get_writePtrAt(size_t idx) {
+    return idx < size() ? &buffer_ptr()[idx] : nullptr;
+  };
+  //Set the number of bytes to send written in place by get_writePtrAt
+  bool setLen(size_t len) {
+    if (len > size()) {
+      return false;
+    }
+    setBytesToTransfer(len);
+    return true;
+  };
+  //Set the sequence number of a DATA packet, the packets without a sequence number are never acknowledged
+  void setSequence(uint8_t seq) {
+    _sequence = seq;
+    _hasSequence = true;
+  };
+  uint8_t getSequence() {
+    return _sequence;
+  };
+  bool hasSequence() {
+    return _hasSequence;
+  };
 
   OutputPacketBuffer &operator+=(uint8_t newChar) {
     copyArray(bytesToTransfer(), &newChar, sizeof(newChar));
+    return *this;
   }
 
   bool copyArray(const uint8_t *srcBuf, size_t len) {
-    copyArray(bytesToTransfer(), srcBuf, len);
+    return copyArray(bytesToTransfer(), srcBuf, len);
   }
 
   bool copyArray(int positionFrom, const uint8_t *srcBuf, size_t len) override {
-    int nextOccupation = bytesToTransfer() + len;
+    size_t nextOccupation = bytesToTransfer() + len;
     bool success = false;
     if (nextOccupation <= size()) {
       setBytes(positionFrom, const_cast<uint8_t *>(srcBuf), len);
@@ -153,6 +218,10 @@ public:
 
     return success;
   }
+
+private:
+  uint8_t _sequence = 0;
+  bool _hasSequence = false;
 };
 
 class InputPacketBuffer : public PacketBuffer {
@@ -179,14 +248,37 @@ public:
   };
   InputPacketBuffer &operator+=(uint8_t newChar) {
     copyArray(transferredBytes(), &newChar, sizeof(newChar));
+    return *this;
   }
 
   bool copyArray(const uint8_t *srcBuf, size_t len) {
-    copyArray(transferredBytes(), srcBuf, len);
+    return copyArray(transferredBytes(), srcBuf, len);
+  }
+
+  //Remove the first len bytes received
+  bool discardFront(size_t len) {
+    if (len > transferredBytes()) {
+      return false;
+    }
+    memmove(buffer_ptr(), &buffer_ptr()[len], transferredBytes() - len);
+    setBytesTransferred(transferredBytes() - len);
+    return true;
+  }
+
+  //Insert srcBuf before the bytes already received
+  bool prependArray(const uint8_t *srcBuf, size_t len) {
+    size_t nextOccupation = transferredBytes() + len;
+    if (nextOccupation > size()) {
+      return false;
+    }
+    memmove(&buffer_ptr()[len], buffer_ptr(), transferredBytes());
+    memcpy(buffer_ptr(), srcBuf, len);
+    setBytesTransferred(nextOccupation);
+    return true;
   }
 
   bool copyArray(int positionFrom, const uint8_t *srcBuf, size_t len) override {
-    int nextOccupation = transferredBytes() + len;
+    size_t nextOccupation = transferredBytes() + len;
     bool success = false;
     if (nextOccupation <= size()) {
       setBytes(positionFrom, const_cast<uint8_t *>(srcBuf), len);
@@ -0,0 +1,53 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "ANetworkConfigurator_Config.h"
+#if NETWORK_CONFIGURATOR_COMPATIBLE
+
+#include "PacketCRC.h"
+
+namespace PacketCRC {
+
+  #define CRC16_REFLECTED_POLYNOMIAL 0x8408 // 0x1021 bit reversed
+  #define CRC16_INITIAL_VALUE 0xffff
+  #define CRC16_FINAL_XOR_VALUE 0xffff
+
+  // Computes an entry of the lookup table shifting the index bit by bit
+  constexpr uint16_t tableEntry(uint16_t crc, int bits) {
+    return bits == 0 ? crc : tableEntry((crc & 1) ? (crc >> 1) ^ CRC16_REFLECTED_POLYNOMIAL : crc >> 1, bits - 1);
+  }
+
+  #define CRC16_ENTRY(n)    tableEntry(n, 8)
+  #define CRC16_ENTRIES4(n)  CRC16_ENTRY(n),      CRC16_ENTRY(n + 1),       CRC16_ENTRY(n + 2),       CRC16_ENTRY(n + 3)
+  #define CRC16_ENTRIES16(n) CRC16_ENTRIES4(n),   CRC16_ENTRIES4(n + 4),    CRC16_ENTRIES4(n + 8),    CRC16_ENTRIES4(n + 12)
+  #define CRC16_ENTRIES64(n) CRC16_ENTRIES16(n),  CRC16_ENTRIES16(n + 16),  CRC16_ENTRIES16(n + 32),  CRC16_ENTRIES16(n + 48)
+
+  static constexpr uint16_t CRC16_TABLE[256] = {
+    CRC16_ENTRIES64(0), CRC16_ENTRIES64(64), CRC16_ENTRIES64(128), CRC16_ENTRIES64(192)
+  };
+
+  uint16_t begin() {
+    return CRC16_INITIAL_VALUE;
+  }
+
+  uint16_t update(uint16_t crc, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      crc = (crc >> 8) ^ CRC16_TABLE[(crc ^ data[i]) & 0xff];
+    }
+    return crc;
+  }
+
+  uint16_t finalize(uint16_t crc) {
+    return crc ^ CRC16_FINAL_XOR_VALUE;
+  }
+
+  uint16_t calculate(const uint8_t *data, size_t len) {
+    return finalize(update(begin(), data, len));
+  }
+}
+
+#endif // NETWORK_CONFIGURATOR_COMPATIBLE
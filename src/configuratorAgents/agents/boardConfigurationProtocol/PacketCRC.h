@@ -0,0 +1,52 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @namespace PacketCRC
+ * @brief CRC16 used by the ArduinoBoardConfiguration Protocol for checking the payload integrity.
+ * The algorithm is CRC-16/X-25: polynomial 0x1021 with reflected input and output,
+ * initial value 0xFFFF and final XOR 0xFFFF. It is implemented with a 256 entries
+ * lookup table generated at compile time, so it processes a byte per iteration.
+ * The CRC can be computed in a single call with calculate() or incrementally:
+ * begin(), update() for each block of data, finalize().
+ */
+namespace PacketCRC {
+  /**
+   * @brief Gets the initial value of an incremental CRC computation.
+   * @return The initial CRC value.
+   */
+  uint16_t begin();
+
+  /**
+   * @brief Updates a running CRC with a block of data.
+   * @param crc The running CRC returned by begin() or by a previous call to update().
+   * @param data Pointer to the data.
+   * @param len Length of the data.
+   * @return The updated running CRC.
+   */
+  uint16_t update(uint16_t crc, const uint8_t *data, size_t len);
+
+  /**
+   * @brief Completes an incremental CRC computation.
+   * @param crc The running CRC.
+   * @return The CRC of all the data passed to update().
+   */
+  uint16_t finalize(uint16_t crc);
+
+  /**
+   * @brief Computes the CRC of a block of data.
+   * @param data Pointer to the data.
+   * @param len Length of the data.
+   * @return The CRC of the data.
+   */
+  uint16_t calculate(const uint8_t *data, size_t len);
+}
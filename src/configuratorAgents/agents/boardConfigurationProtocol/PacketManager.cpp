@@ -8,50 +8,60 @@
 #include "ANetworkConfigurator_Config.h"
 #if NETWORK_CONFIGURATOR_COMPATIBLE
 
+#include <utility>
 #include <Arduino_DebugUtils.h>
 #include "PacketManager.h"
-#include "Arduino_CRC16.h"
+#include "PacketCRC.h"
 
 namespace PacketManager {
 
   uint8_t PACKET_START[] = { 0x55, 0xaa };
   uint8_t PACKET_END[] = { 0xaa, 0x55 };
-  #define PACKET_START_SIZE 2
-  #define PACKET_END_SIZE 2
-  #define PACKET_TYPE_SIZE 1
-  #define PACKET_LENGTH_SIZE 2
-  #define PACKET_CRC_SIZE 2
-  #define PACKET_HEADERS_OVERHEAD PACKET_START_SIZE + PACKET_TYPE_SIZE + PACKET_LENGTH_SIZE + PACKET_CRC_SIZE + PACKET_END_SIZE
-  #define PACKET_MINIMUM_SIZE PACKET_START_SIZE + PACKET_TYPE_SIZE + PACKET_LENGTH_SIZE
-
-  #define CRC16_POLYNOMIAL 0x1021
-  #define CRC16_INITIAL_VALUE 0xffff
-  #define CRC16_FINAL_XOR_VALUE 0xffff
-  #define CRC16_REFLECT_DATA true
-  #define CRC16_REFLECT_RESULT true
+
   #define BYTES_VALIDITY_MS 10000
+  //Room reserved after the payload for rescanning the rest of the header and the trailer of a rejected packet
+  #define PACKET_RESCAN_MARGIN (PACKET_TYPE_SIZE + PACKET_LENGTH_SIZE + PACKET_CRC_SIZE + PACKET_END_SIZE)
 
   bool createPacket(OutputPacketBuffer &outputMsg, MessageType type, const uint8_t *data, size_t len) {
+    uint8_t *payload = reservePacket(outputMsg, len);
+    if (payload == nullptr) {
+      return false;
+    }
+
+    memcpy(payload, data, len);
+    return finalizePacket(outputMsg, type, len);
+  }
+
+  uint8_t *reservePacket(OutputPacketBuffer &outputMsg, size_t maxLen) {
+    if (!outputMsg.allocate(maxLen + PACKET_HEADERS_OVERHEAD + PACKET_SEQUENCE_SIZE)) {
+      return nullptr;
+    }
+
+    return outputMsg.get_writePtrAt(PACKET_MINIMUM_SIZE);
+  }
+
+  bool finalizePacket(OutputPacketBuffer &outputMsg, MessageType type, size_t len) {
+    // The payload must fit the reserved buffer
     uint16_t packetLen = len + PACKET_HEADERS_OVERHEAD;
+    if (!outputMsg.setLen(packetLen)) {
+      return false;
+    }
     uint16_t payloadLen = len + PACKET_CRC_SIZE;
     uint8_t payloadLenHigh = payloadLen >> 8;
     uint8_t payloadLenLow = payloadLen & 0xff;
-    uint16_t payloadCRC = arduino::crc16::calculate((char *)data, len, CRC16_POLYNOMIAL, CRC16_INITIAL_VALUE, CRC16_FINAL_XOR_VALUE, CRC16_REFLECT_DATA, CRC16_REFLECT_RESULT);
+    uint16_t payloadCRC = PacketCRC::calculate(outputMsg.get_ptrAt(PACKET_MINIMUM_SIZE), len);
     uint8_t crcHigh = payloadCRC >> 8;
     uint8_t crcLow = payloadCRC & 0xff;
 
-    outputMsg.allocate(packetLen);
-
+    // The payload is already in place, the header is written before it
+    outputMsg.setLen(0);
     outputMsg += PACKET_START[0];
     outputMsg += PACKET_START[1];
     outputMsg += (uint8_t)type;
     outputMsg += payloadLenHigh;
     outputMsg += payloadLenLow;
 
-    if (!outputMsg.copyArray(data, len)) {
-      return false;
-    }
-
+    outputMsg.setLen(PACKET_MINIMUM_SIZE + len);
     outputMsg += crcHigh;
     outputMsg += crcLow;
     outputMsg += PACKET_END[0];
@@ -61,46 +71,153 @@ namespace PacketManager {
     return true;
   }
 
+  bool addSequence(OutputPacketBuffer &outputMsg, uint8_t seq) {
+    size_t len = outputMsg.len();
+    if (len < PACKET_HEADERS_OVERHEAD || outputMsg[2] != (uint8_t)MessageType::DATA) {
+      return false;
+    }
+
+    size_t payloadLen = len - PACKET_HEADERS_OVERHEAD;
+    uint8_t *payload = outputMsg.get_writePtrAt(PACKET_MINIMUM_SIZE);
+    if (payload == nullptr || outputMsg.get_writePtrAt(len) == nullptr) {
+      return false;
+    }
+
+    memmove(&payload[PACKET_SEQUENCE_SIZE], payload, payloadLen);
+    payload[0] = seq;
+    return finalizePacket(outputMsg, MessageType::SEQUENCED_DATA, payloadLen + PACKET_SEQUENCE_SIZE);
+  }
+
   PacketManager::ReceivingState PacketReceiver::handleReceivedByte(Packet_t &packet, uint8_t byte) {
-    if (_state == ReceivingState::ERROR || _state == ReceivingState::RECEIVED) {
+    size_t consumed = 0;
+    return handleReceivedChunk(packet, &byte, sizeof(byte), consumed);
+  }
+
+  PacketManager::ReceivingState PacketReceiver::handleReceivedChunk(Packet_t &packet, const uint8_t *chunk, size_t len, size_t &consumed) {
+    consumed = 0;
+    if (isFinalState(_state)) {
       _state = ReceivingState::WAITING_HEADER;
     }
 
-    if (millis() - packet.LastByteReceivedTs > BYTES_VALIDITY_MS) {
+    uint32_t now = millis();
+    if (now - packet.LastByteReceivedTs > BYTES_VALIDITY_MS) {
       clear(packet);
     }
 
-    packet.LastByteReceivedTs = millis();
+    packet.LastByteReceivedTs = now;
 
-    switch (_state) {
-      case ReceivingState::WAITING_HEADER:  _state = handle_WaitingHeader (packet,byte); break;
-      case ReceivingState::WAITING_PAYLOAD: _state = handle_WaitingPayload(packet,byte); break;
-      case ReceivingState::WAITING_END:     _state = handle_WaitingEnd    (packet,byte); break;
-      default:                                                                           break;
+    //The bytes following a false start marker are scanned again before the new ones
+    bool rescanning = false;
+    if (hasPendingBytes(packet)) {
+      size_t used = 0;
+      _state = handleBytes(packet, packet.Rescan.get_ptrAt(packet.RescanOffset), packet.Rescan.len() - packet.RescanOffset, used);
+      packet.RescanOffset += used;
+      rescanning = isFinalState(_state);
+    }
+
+    if (!rescanning) {
+      releaseRescan(packet);
+      _state = handleBytes(packet, chunk, len, consumed);
     }
 
     if (_state == ReceivingState::RECEIVED) {
       packet.Type = (MessageType)getPacketType(packet);
-      if (packet.Type != MessageType::TRANSMISSION_CONTROL && packet.Type != MessageType::DATA) {
+      if (packet.Type != MessageType::TRANSMISSION_CONTROL && packet.Type != MessageType::DATA &&
+          packet.Type != MessageType::SEQUENCED_DATA) {
         //Packet type not recognized
         _state = ReceivingState::ERROR;
       }
     }
 
-    if (_state == ReceivingState::ERROR) {
+    if (_state != ReceivingState::RECEIVED && isFinalState(_state)) {
+      rescanAfterStartMarker(packet, rescanning);
       clear(packet);
     }
 
     return _state;
   }
 
+  bool PacketReceiver::hasPendingBytes(Packet_t &packet) {
+    return packet.RescanOffset < packet.Rescan.len();
+  }
+
   void PacketReceiver::clear(Packet_t &packet) {
+    if (!isFinalState(_state)) {
+      _state = ReceivingState::WAITING_HEADER;
+    }
     packet.LastByteReceivedTs = 0;
+    packet.PayloadCRC = PacketCRC::begin();
     packet.Header.clear();
     packet.Payload.reset();
     packet.Trailer.clear();
   }
 
+  void PacketReceiver::reset(Packet_t &packet) {
+    clear(packet);
+    releaseRescan(packet);
+  }
+
+  PacketManager::ReceivingState PacketReceiver::handleBytes(Packet_t &packet, const uint8_t *data, size_t len, size_t &used) {
+    used = 0;
+    while (used < len) {
+      size_t n = 0;
+      switch (_state) {
+        case ReceivingState::WAITING_HEADER:  _state = handle_WaitingHeader (packet, &data[used], len - used, n); break;
+        case ReceivingState::WAITING_PAYLOAD: _state = handle_WaitingPayload(packet, &data[used], len - used, n); break;
+        case ReceivingState::WAITING_END:     _state = handle_WaitingEnd    (packet, &data[used], len - used, n); break;
+        default:                                                                                                  break;
+      }
+      used += n;
+
+      if (isFinalState(_state)) {
+        break;
+      }
+    }
+
+    return _state;
+  }
+
+  void PacketReceiver::rescanAfterStartMarker(Packet_t &packet, bool rescanning) {
+    //All the bytes following the start marker of the rejected packet are stored in its header, payload and trailer
+    size_t headerLen = packet.Header.len() > PACKET_START_SIZE ? packet.Header.len() - PACKET_START_SIZE : 0;
+    size_t scanned = headerLen + packet.Payload.len() + packet.Trailer.len();
+
+    if (rescanning) {
+      //The rejected packet started in the bytes being scanned again, they are still in the buffer
+      packet.RescanOffset -= scanned;
+      return;
+    }
+
+    uint8_t header[PACKET_TYPE_SIZE + PACKET_LENGTH_SIZE];
+    for (size_t i = 0; i < headerLen; i++) {
+      header[i] = packet.Header[PACKET_START_SIZE + i];
+    }
+    uint8_t trailer[PACKET_CRC_SIZE + PACKET_END_SIZE];
+    for (size_t i = 0; i < packet.Trailer.len(); i++) {
+      trailer[i] = packet.Trailer[i];
+    }
+
+    //The payload buffer is allocated with room for the header and the trailer, the bytes are rearranged in place
+    releaseRescan(packet);
+    if (packet.Payload.get_ptr() != nullptr) {
+      packet.Rescan = std::move(packet.Payload);
+    } else if (!packet.Rescan.allocate(headerLen + packet.Trailer.len())) {
+      return;
+    }
+    packet.Rescan.prependArray(header, headerLen);
+    packet.Rescan.copyArray(trailer, packet.Trailer.len());
+  }
+
+  void PacketReceiver::releaseRescan(Packet_t &packet) {
+    packet.Rescan.reset();
+    packet.RescanOffset = 0;
+  }
+
+  bool PacketReceiver::isFinalState(ReceivingState state) {
+    return state == ReceivingState::RECEIVED || state == ReceivingState::ERROR ||
+           state == ReceivingState::INVALID_LENGTH || state == ReceivingState::NO_BUFFER;
+  }
+
   bool PacketReceiver::checkBeginPacket(Packet_t &packet) {
     if (packet.Header.len() < sizeof(PACKET_START)) {
       return false;
@@ -124,11 +241,11 @@ namespace PacketManager {
   }
 
   bool PacketReceiver::checkCRC(Packet_t &packet) {
-    if (packet.Trailer.len() < sizeof(PACKET_END) + PACKET_CRC_SIZE) {
+    if (packet.Trailer.len() < PACKET_CRC_SIZE) {
       return false;
     }
     uint16_t receivedCRC = ((uint16_t)packet.Trailer[0] << 8 | packet.Trailer[1]);
-    uint16_t computedCRC = arduino::crc16::calculate((char *)&packet.Payload[0], packet.Payload.len(), CRC16_POLYNOMIAL, CRC16_INITIAL_VALUE, CRC16_FINAL_XOR_VALUE, CRC16_REFLECT_DATA, CRC16_REFLECT_RESULT);
+    uint16_t computedCRC = PacketCRC::finalize(packet.PayloadCRC);
 
     if (receivedCRC == computedCRC) {
       return true;
@@ -149,45 +266,91 @@ namespace PacketManager {
     return ((uint16_t)packet.Header[3] << 8 | packet.Header[4]);
   }
 
-  PacketManager::ReceivingState PacketReceiver::handle_WaitingHeader(Packet_t &packet, uint8_t byte) {
-    if (packet.Header.missingBytes() > 0) {
-      packet.Header += byte;
+  PacketManager::ReceivingState PacketReceiver::handle_WaitingHeader(Packet_t &packet, const uint8_t *data, size_t len, size_t &used) {
+    used = 0;
+    //Discard the bytes preceding the start of the packet
+    while (packet.Header.len() < PACKET_START_SIZE && used < len) {
+      if (packet.Header.len() == 0) {
+        const uint8_t *start = (const uint8_t *)memchr(&data[used], PACKET_START[0], len - used);
+        if (start == nullptr) {
+          used = len;
+          break;
+        }
+        used = start - data;
+      }
+
+      uint8_t byte = data[used++];
+      if (byte == PACKET_START[packet.Header.len()]) {
+        packet.Header += byte;
+      } else {
+        //In a sequence 0x55 0x55 0xaa the packet starts from the second byte
+        packet.Header.clear();
+        if (byte == PACKET_START[0]) {
+          packet.Header += byte;
+        }
+      }
+    }
+
+    if (packet.Header.len() < PACKET_START_SIZE) {
+      return ReceivingState::WAITING_HEADER;
     }
 
+    size_t missing = packet.Header.missingBytes() < len - used ? packet.Header.missingBytes() : len - used;
+    packet.Header.copyArray(&data[used], missing);
+    used += missing;
+
     if (packet.Header.receivedAll()) {
       if (!checkBeginPacket(packet)) {
         return ReceivingState::ERROR;
       }
 
       uint16_t packetLen = getPacketLen(packet);
+      //The length must include the CRC and the whole packet must fit BCP_MAX_FRAME_SIZE
+      if (packetLen < PACKET_CRC_SIZE || (size_t)packetLen + PACKET_MINIMUM_SIZE + PACKET_END_SIZE > BCP_MAX_FRAME_SIZE) {
+        DEBUG_WARNING("PacketReceiver::%s invalid packet length: %d", __FUNCTION__, packetLen);
+        return ReceivingState::INVALID_LENGTH;
+      }
+
       uint16_t payloadLen = packetLen - PACKET_CRC_SIZE;
-      packet.Payload.allocate(payloadLen);
+      if (!packet.Payload.allocate(payloadLen + PACKET_RESCAN_MARGIN)) {
+        DEBUG_WARNING("PacketReceiver::%s no buffer available for a payload of %d bytes", __FUNCTION__, payloadLen);
+        return ReceivingState::NO_BUFFER;
+      }
       packet.Payload.setPayloadLen(payloadLen);
+      packet.PayloadCRC = PacketCRC::begin();
+      if (payloadLen == 0) {
+        return ReceivingState::WAITING_END;
+      }
       return ReceivingState::WAITING_PAYLOAD;
     }
 
     return ReceivingState::WAITING_HEADER;
   }
 
-  PacketManager::ReceivingState PacketReceiver::handle_WaitingPayload(Packet_t &packet, uint8_t byte) {
-    if (packet.Payload.missingBytes() > 0) {
-      packet.Payload += byte;
-    }
+  PacketManager::ReceivingState PacketReceiver::handle_WaitingPayload(Packet_t &packet, const uint8_t *data, size_t len, size_t &used) {
+    used = packet.Payload.missingBytes() < len ? packet.Payload.missingBytes() : len;
+    packet.Payload.copyArray(data, used);
+    packet.PayloadCRC = PacketCRC::update(packet.PayloadCRC, data, used);
 
     if (packet.Payload.receivedAll()) {
-    return ReceivingState::WAITING_END;
+      return ReceivingState::WAITING_END;
     }
 
     return ReceivingState::WAITING_PAYLOAD;
   }
 
-  PacketManager::ReceivingState PacketReceiver::handle_WaitingEnd(Packet_t &packet ,uint8_t byte) {
-    if (packet.Trailer.missingBytes() > 0) {
-      packet.Trailer += byte;
+  PacketManager::ReceivingState PacketReceiver::handle_WaitingEnd(Packet_t &packet, const uint8_t *data, size_t len, size_t &used) {
+    //The CRC is copied and checked first, so a corrupted packet is rejected without waiting for its end
+    size_t missing = packet.Trailer.len() < PACKET_CRC_SIZE ? PACKET_CRC_SIZE - packet.Trailer.len() : packet.Trailer.missingBytes();
+    used = missing < len ? missing : len;
+    packet.Trailer.copyArray(data, used);
+
+    if (packet.Trailer.len() == PACKET_CRC_SIZE && !checkCRC(packet)) {
+      return ReceivingState::ERROR;
     }
 
     if (packet.Trailer.receivedAll()) {
-      if (checkCRC(packet) && checkEndPacket(packet)) {
+      if (checkEndPacket(packet)) {
         return ReceivingState::RECEIVED;
       } else {
         //Error
@@ -15,20 +15,46 @@
  * @brief Provides functionality for managing packets, including creating, receiving,
  * and validating packets with the ArduinoBoardConfiguration Protocol packet structure.
  */
+#define PACKET_START_SIZE 2
+#define PACKET_END_SIZE 2
+#define PACKET_TYPE_SIZE 1
+#define PACKET_LENGTH_SIZE 2
+#define PACKET_CRC_SIZE 2
+#define PACKET_SEQUENCE_SIZE 1
+#define PACKET_HEADERS_OVERHEAD (PACKET_START_SIZE + PACKET_TYPE_SIZE + PACKET_LENGTH_SIZE + PACKET_CRC_SIZE + PACKET_END_SIZE)
+#define PACKET_MINIMUM_SIZE (PACKET_START_SIZE + PACKET_TYPE_SIZE + PACKET_LENGTH_SIZE)
+
 namespace PacketManager {
   enum class ReceivingState { WAITING_HEADER,
                               WAITING_PAYLOAD,
                               WAITING_END,
                               RECEIVED,
-                              ERROR };
+                              ERROR,
+                              INVALID_LENGTH,
+                              NO_BUFFER };
 
   enum class MessageType { DATA     = 2,
-                           TRANSMISSION_CONTROL = 3 };
+                           TRANSMISSION_CONTROL = 3,
+                           SEQUENCED_DATA = 4 };
 
   enum class TransmissionControlMessage : uint8_t{
     CONNECT    = 0x01,
     DISCONNECT = 0x02,
-    NACK       = 0x03 };
+    NACK       = 0x03,
+    ACK        = 0x04 };
+
+  /*
+   * The DATA packets are numbered by each side with an 8 bit sequence number,
+   * starting from 0 when the peer connects and wrapping around after 255.
+   * A TRANSMISSION_CONTROL payload of a single byte is the legacy form: a NACK asks to
+   * resend all the queued packets and every DATA packet acknowledges the packets sent before it.
+   * A payload of two bytes <NACK|ACK> <seq> enables the selective mode:
+   *  - the data packets are sent as SEQUENCED_DATA, the first byte of the payload is the sequence number
+   *  - ACK <seq> acknowledges all the data packets up to <seq> included
+   *  - NACK <seq> asks to resend only the data packet <seq>
+   *  - the data packets received twice or after a missing one are discarded, the missing one is NACKed
+   * In selective mode up to BCP_SEND_WINDOW data packets are in flight waiting for an ACK.
+   */
 
   /*
    * The ArduinoBoardConfiguration Protocol packet structure
@@ -38,7 +64,7 @@ namespace PacketManager {
    * |______________________HEADER_____________________|__________ PAYLOAD _________|_____________________ TRAILER _______________________|
    * | 0x55    | 0xaa    | <type>  | <len>             | <payload>                  | <crc>                     | 0xaa      | 0x55        |
    * |____________________________________________________________________________________________________________________________________|
-   * <type> = MessageType: 2 = DATA, 3 = TRANSMISSION_CONTROL
+   * <type> = MessageType: 2 = DATA, 3 = TRANSMISSION_CONTROL, 4 = SEQUENCED_DATA
    * <len> = length of the payload + 2 bytes for the CRC
    * <payload> = the data to be sent or received
    * <crc> = CRC16 of the payload
@@ -47,8 +73,11 @@ namespace PacketManager {
     InputPacketBuffer Header = {5};
     InputPacketBuffer Payload;
     InputPacketBuffer Trailer = {4};
+    uint16_t PayloadCRC = 0; // Running CRC of the payload bytes received so far
     uint32_t LastByteReceivedTs = 0;
     MessageType Type;
+    InputPacketBuffer Rescan; // Bytes following the start marker of a rejected packet, scanned again before the new ones
+    size_t RescanOffset = 0;
   } Packet_t;
 
   /**
@@ -65,6 +94,39 @@ namespace PacketManager {
    */
   bool createPacket(OutputPacketBuffer &msg, MessageType type, const uint8_t *data, size_t len);
 
+  /**
+   * @brief Reserves a packet for a payload of up to maxLen bytes.
+   * The payload is written directly in the returned buffer, without copies,
+   * and the packet is completed by finalizePacket().
+   *
+   * @param[out] msg The output buffer where the packet will be stored.
+   * @param[in] maxLen The maximum length of the payload.
+   * @return Pointer to the payload area of the packet, nullptr if the buffer can't be allocated.
+   */
+  uint8_t *reservePacket(OutputPacketBuffer &msg, size_t maxLen);
+
+  /**
+   * @brief Completes a packet reserved by reservePacket() adding the header
+   * and the trailer, including the CRC16 checksum of the payload.
+   *
+   * @param[in,out] msg The output buffer reserved by reservePacket().
+   * @param[in] type The type of the message (e.g., DATA or TRANSMISSION_CONTROL).
+   * @param[in] len The length of the payload written, up to the reserved maxLen.
+   * @return true if the packet was successfully completed, false otherwise.
+   */
+  bool finalizePacket(OutputPacketBuffer &msg, MessageType type, size_t len);
+
+  /**
+   * @brief Converts in place a DATA packet in a SEQUENCED_DATA packet, adding the
+   * sequence number before the payload. The packets created by createPacket() and
+   * reservePacket() have room for the sequence number.
+   *
+   * @param[in,out] msg The DATA packet to convert.
+   * @param[in] seq The sequence number of the packet.
+   * @return true if the packet was converted, false otherwise.
+   */
+  bool addSequence(OutputPacketBuffer &msg, uint8_t seq);
+
 
   /**
    * @class PacketReceiver
@@ -81,6 +143,28 @@ namespace PacketManager {
        */
       ReceivingState handleReceivedByte(Packet_t &packet, uint8_t byte);
 
+      /**
+       * @brief Handles a chunk of received bytes and updates the packet state.
+       * The bytes are copied span by span into the header, payload and trailer
+       * of the packet. While waiting for the header, the bytes preceding the start
+       * marker 0x55 0xaa are discarded without raising errors. The processing
+       * stops as soon as a packet is completely received or an error is detected,
+       * the remaining bytes of the chunk must be passed again by the caller.
+       * NO_BUFFER is returned when the packet is valid so far but the PacketPool
+       * is exhausted: the packet is dropped and the peer can send it again later.
+       * When a packet is rejected the bytes following its start marker are kept and
+       * scanned again before the new ones, so a false start marker doesn't hide the
+       * packets received after it. While hasPendingBytes() is true the caller must
+       * call this method again, even with no new bytes.
+       *
+       * @param packet Reference to the packet being reconstructed.
+       * @param chunk Pointer to the received bytes.
+       * @param len Number of received bytes.
+       * @param consumed Returns the number of bytes of the chunk processed.
+       * @return The current state of the receiving process.
+       */
+      ReceivingState handleReceivedChunk(Packet_t &packet, const uint8_t *chunk, size_t len, size_t &consumed);
+
       /**
        * @brief Retrieves the singleton instance of the PacketReceiver.
        * @return Reference to the singleton instance of PacketReceiver.
@@ -89,16 +173,34 @@ namespace PacketManager {
         static PacketReceiver instance;
         return instance;
       }
+      /**
+       * @brief Checks if there are bytes of a rejected packet still to be scanned again.
+       * @param packet Reference to the packet being reconstructed.
+       * @return True if handleReceivedChunk() must be called again.
+       */
+      bool hasPendingBytes(Packet_t &packet);
+
       /**
        * @brief Clears the contents of the given packet and resets its state.
+       * The bytes to be scanned again after a rejected packet are kept.
        * @param packet Reference to the packet to be cleared.
        */
       void clear(Packet_t &packet);
+
+      /**
+       * @brief Clears the given packet and discards the bytes to be scanned again.
+       * @param packet Reference to the packet to be reset.
+       */
+      void reset(Packet_t &packet);
     private:
       ReceivingState _state = ReceivingState::WAITING_HEADER;
-      ReceivingState handle_WaitingHeader(Packet_t &packet, uint8_t byte);
-      ReceivingState handle_WaitingPayload(Packet_t &packet, uint8_t byte);
-      ReceivingState handle_WaitingEnd(Packet_t &packet, uint8_t byte);
+      ReceivingState handleBytes(Packet_t &packet, const uint8_t *data, size_t len, size_t &used);
+      void rescanAfterStartMarker(Packet_t &packet, bool rescanning);
+      void releaseRescan(Packet_t &packet);
+      ReceivingState handle_WaitingHeader(Packet_t &packet, const uint8_t *data, size_t len, size_t &used);
+      ReceivingState handle_WaitingPayload(Packet_t &packet, const uint8_t *data, size_t len, size_t &used);
+      ReceivingState handle_WaitingEnd(Packet_t &packet, const uint8_t *data, size_t len, size_t &used);
+      bool isFinalState(ReceivingState state);
       bool checkBeginPacket(Packet_t &packet);
       bool checkEndPacket(Packet_t &packet);
       bool checkCRC(Packet_t &packet);
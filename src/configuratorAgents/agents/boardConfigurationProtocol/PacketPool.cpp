@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "ANetworkConfigurator_Config.h"
+#if NETWORK_CONFIGURATOR_COMPATIBLE
+
+#include "PacketPool.h"
+
+uint8_t *PacketPool::acquire(size_t n) {
+  if (n > BCP_PACKET_POOL_SLOT_SIZE) {
+    return nullptr;
+  }
+
+  uint8_t *buf = nullptr;
+  if (n <= BCP_PACKET_POOL_SMALL_SLOT_SIZE) {
+    buf = _smallSlots.acquire();
+  }
+
+  if (buf == nullptr) {
+    buf = _slots.acquire();
+  }
+
+  return buf;
+}
+
+void PacketPool::release(uint8_t *buf) {
+  if (!_smallSlots.release(buf)) {
+    _slots.release(buf);
+  }
+}
+
+size_t PacketPool::freeSlots(size_t n) {
+  if (n > BCP_PACKET_POOL_SLOT_SIZE) {
+    return 0;
+  }
+
+  size_t count = _slots.freeSlots();
+  if (n <= BCP_PACKET_POOL_SMALL_SLOT_SIZE) {
+    count += _smallSlots.freeSlots();
+  }
+  return count;
+}
+
+#endif // NETWORK_CONFIGURATOR_COMPATIBLE
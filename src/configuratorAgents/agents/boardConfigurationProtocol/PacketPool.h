@@ -0,0 +1,101 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+#include "Arduino.h"
+#include "ANetworkConfigurator_Config.h"
+
+/**
+ * @class PacketPool
+ * @brief Singleton class that owns a fixed number of statically allocated buffers
+ * used for storing the packets of the ArduinoBoardConfiguration Protocol.
+ * The buffers are split in two size classes, so the small packets don't hold the buffers
+ * sized for the biggest ones:
+ * - BCP_PACKET_POOL_SMALL_SLOTS buffers of BCP_PACKET_POOL_SMALL_SLOT_SIZE bytes
+ * - BCP_PACKET_POOL_SLOTS buffers of BCP_PACKET_POOL_SLOT_SIZE bytes
+ * The number and the size of the buffers are configured at compile time, so the memory
+ * used by the protocol is deterministic and the heap is never used.
+ */
+class PacketPool {
+public:
+  /**
+   * @brief Retrieves the singleton instance of the PacketPool.
+   * @return Reference to the singleton instance of PacketPool.
+   */
+  static PacketPool &getInstance() {
+    static PacketPool instance;
+    return instance;
+  }
+
+  /**
+   * @brief Takes a free buffer from the pool. The small buffers are used first,
+   * the big ones only if n doesn't fit a small buffer or if the small buffers are exhausted.
+   * @param n The number of bytes requested.
+   * @return Pointer to the buffer, nullptr if the pool is exhausted
+   * or if n exceeds BCP_PACKET_POOL_SLOT_SIZE.
+   */
+  uint8_t *acquire(size_t n);
+
+  /**
+   * @brief Gives back to the pool a buffer obtained with acquire().
+   * @param buf Pointer to the buffer to release.
+   */
+  void release(uint8_t *buf);
+
+  /**
+   * @brief Get the number of buffers not in use that can store n bytes.
+   * @param n The number of bytes to store, by default the size of the big buffers.
+   * @return The number of free buffers.
+   */
+  size_t freeSlots(size_t n = BCP_PACKET_POOL_SLOT_SIZE);
+
+private:
+  template <size_t SLOTS, size_t SIZE>
+  class SlotArray {
+  public:
+    uint8_t *acquire() {
+      for (size_t i = 0; i < SLOTS; i++) {
+        if (!_used[i]) {
+          _used[i] = true;
+          return _slots[i];
+        }
+      }
+      return nullptr;
+    }
+
+    // Returns false if the buffer doesn't belong to this array
+    bool release(uint8_t *buf) {
+      if (buf < &_slots[0][0] || buf > &_slots[SLOTS - 1][0]) {
+        return false;
+      }
+      size_t idx = (buf - &_slots[0][0]) / SIZE;
+      if (_slots[idx] == buf) {
+        _used[idx] = false;
+      }
+      return true;
+    }
+
+    size_t freeSlots() {
+      size_t count = 0;
+      for (size_t i = 0; i < SLOTS; i++) {
+        if (!_used[i]) {
+          count++;
+        }
+      }
+      return count;
+    }
+
+  private:
+    uint8_t _slots[SLOTS][SIZE];
+    bool _used[SLOTS] = { false };
+  };
+
+  PacketPool() {};
+  SlotArray<BCP_PACKET_POOL_SMALL_SLOTS, BCP_PACKET_POOL_SMALL_SLOT_SIZE> _smallSlots;
+  SlotArray<BCP_PACKET_POOL_SLOTS, BCP_PACKET_POOL_SLOT_SIZE> _slots;
+};
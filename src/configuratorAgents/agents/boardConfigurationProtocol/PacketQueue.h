@@ -0,0 +1,114 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+#include <stddef.h>
+#include <utility>
+
+/**
+ * @class PacketQueue
+ * @brief Fixed size FIFO ring queue of packet buffers.
+ * The elements are stored inside the queue and are moved in and out of it,
+ * so push, pop and front are O(1) and the heap is never used.
+ * @tparam T The type of the stored elements, it must be move assignable.
+ * @tparam N The maximum number of elements of the queue.
+ */
+template <typename T, size_t N>
+class PacketQueue {
+public:
+  /**
+   * @brief Moves an element at the end of the queue.
+   * @param item The element to enqueue.
+   * @return True if the element has been enqueued, false if the queue is full.
+   */
+  bool push(T &&item) {
+    if (full()) {
+      return false;
+    }
+    _items[(_head + _count) % N] = std::move(item);
+    _count++;
+    return true;
+  }
+
+  /**
+   * @brief Gets the oldest element of the queue. The queue must not be empty.
+   * @return Reference to the oldest element.
+   */
+  T &front() {
+    return _items[_head];
+  }
+
+  /**
+   * @brief Removes the oldest element of the queue, if any.
+   */
+  void pop() {
+    if (empty()) {
+      return;
+    }
+    _items[_head].reset();
+    _head = (_head + 1) % N;
+    _count--;
+  }
+
+  /**
+   * @brief Gets the element at the specified position, starting from the oldest one.
+   * @param idx The position of the element, it must be lower than size().
+   * @return Reference to the element.
+   */
+  T &operator[](size_t idx) {
+    return _items[(_head + idx) % N];
+  }
+
+  /**
+   * @brief Removes the elements matching a predicate, the order of the other elements is kept.
+   * @param pred Callable taking a reference to an element, it returns true if the element must be removed.
+   */
+  template <typename Predicate>
+  void removeIf(Predicate pred) {
+    size_t kept = 0;
+    for (size_t i = 0; i < _count; i++) {
+      T &item = (*this)[i];
+      if (pred(item)) {
+        item.reset();
+        continue;
+      }
+      if (kept != i) {
+        (*this)[kept] = std::move(item);
+      }
+      kept++;
+    }
+    _count = kept;
+  }
+
+  /**
+   * @brief Removes all the elements of the queue.
+   */
+  void clear() {
+    while (!empty()) {
+      pop();
+    }
+    _head = 0;
+  }
+
+  size_t size() {
+    return _count;
+  }
+
+  bool empty() {
+    return _count == 0;
+  }
+
+  bool full() {
+    return _count == N;
+  }
+
+private:
+  T _items[N];
+  size_t _head = 0;
+  size_t _count = 0;
+};
@@ -0,0 +1,23 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "ANetworkConfigurator_Config.h"
+#if NETWORK_CONFIGURATOR_COMPATIBLE
+
+#include "CBORInstances.h"
+
+StatusProvisioningMessageEncoder             statusProvisioningMessageEncoder;
+ListWifiNetworksProvisioningMessageEncoder   listWifiNetworksProvisioningMessageEncoder;
+WifiNetworksUpdateProvisioningMessageEncoder wifiNetworksUpdateProvisioningMessageEncoder;
+UniqueHardwareIdProvisioningMessageEncoder   uniqueHardwareIdProvisioningMessageEncoder;
+JWTProvisioningMessageEncoder                jWTProvisioningMessageEncoder;
+ProvPublicKeyProvisioningMessageEncoder      provPublicKeyProvisioningMessageEncoder;
+BLEMacAddressProvisioningMessageEncoder      bLEMacAddressProvisioningMessageEncoder;
+ProvSketchVersionProvisioningMessageEncoder  provSketchVersionProvisioningMessageEncoder;
+NetConfigLibVersProvisioningMessageEncoder   netConfigLibVersProvisioningMessageEncoder;
+
+#endif // NETWORK_CONFIGURATOR_COMPATIBLE
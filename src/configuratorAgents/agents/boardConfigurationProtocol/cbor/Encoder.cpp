@@ -53,6 +53,30 @@ MessageEncoder::Status ListWifiNetworksProvisioningMessageEncoder::encode(CborEn
   return MessageEncoder::Status::Complete;
 }
 
+MessageEncoder::Status WifiNetworksUpdateProvisioningMessageEncoder::encode(CborEncoder* encoder, Message *msg) {
+  WifiNetworksUpdateProvisioningMessage * provisioningWifiNetworksUpdate = (WifiNetworksUpdateProvisioningMessage*) msg;
+  CborEncoder array_encoder;
+
+  if(cbor_encoder_create_array(encoder,
+      &array_encoder,
+      2 * provisioningWifiNetworksUpdate->numDiscoveredWiFiNetworks) != CborNoError) {
+    return MessageEncoder::Status::Error;
+  }
+
+  for (int i = 0; i < provisioningWifiNetworksUpdate->numDiscoveredWiFiNetworks; i++) {
+    if(cbor_encode_text_stringz(&array_encoder, provisioningWifiNetworksUpdate->discoveredWifiNetworks[i].SSID) != CborNoError ||
+        cbor_encode_int(&array_encoder, *provisioningWifiNetworksUpdate->discoveredWifiNetworks[i].RSSI) != CborNoError) {
+      return MessageEncoder::Status::Error;
+    }
+  }
+
+  if(cbor_encoder_close_container(encoder, &array_encoder) != CborNoError) {
+    return MessageEncoder::Status::Error;
+  }
+
+  return MessageEncoder::Status::Complete;
+}
+
 MessageEncoder::Status UniqueHardwareIdProvisioningMessageEncoder::encode(CborEncoder* encoder, Message *msg) {
   UniqueHardwareIdProvisioningMessage * provisioningUniqueHardwareId = (UniqueHardwareIdProvisioningMessage*) msg;
   CborEncoder array_encoder;
@@ -28,6 +28,14 @@ protected:
   MessageEncoder::Status encode(CborEncoder* encoder, Message *msg) override;
 };
 
+class WifiNetworksUpdateProvisioningMessageEncoder: public CBORMessageEncoderInterface {
+public:
+  WifiNetworksUpdateProvisioningMessageEncoder()
+  : CBORMessageEncoderInterface(CBORWifiNetworksUpdateProvisioningMessage, WifiNetworksUpdateProvisioningMessageId) {}
+protected:
+  MessageEncoder::Status encode(CborEncoder* encoder, Message *msg) override;
+};
+
 class UniqueHardwareIdProvisioningMessageEncoder: public CBORMessageEncoderInterface {
 public:
   UniqueHardwareIdProvisioningMessageEncoder()
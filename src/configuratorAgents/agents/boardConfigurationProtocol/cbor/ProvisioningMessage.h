@@ -29,7 +29,6 @@
 #define LOGIN_SIZE                  65 // Max length of login is 64 + \0
 #define PASS_SIZE                   65 // Max length of password is 64 + \0
 #define BAND_SIZE                    4
-#define MAX_WIFI_NETWORKS           20
 #define MAX_IP_SIZE                 16
 
 enum CBORProvisioningMessageTag: CBORTag {
@@ -51,6 +50,7 @@ enum CBORProvisioningMessageTag: CBORTag {
   CBORProvSketchVersionProvisioningMessage  = 0x012015,
   CBORNetConfigLibVersProvisioningMessage   = 0x012016,
   CBORProvPublicKeyProvisioningMessage      = 0x012017,
+  CBORWifiNetworksUpdateProvisioningMessage = 0x012018,
 };
 
 enum ProvisioningMessageId: MessageId {
@@ -72,6 +72,7 @@ enum ProvisioningMessageId: MessageId {
   CATM1ConfigProvisioningMessageId,
   EthernetConfigProvisioningMessageId,
   CellularConfigProvisioningMessageId,
+  WifiNetworksUpdateProvisioningMessageId,
 };
 
 typedef Message ProvisioningMessage;
@@ -96,6 +97,9 @@ struct ListWifiNetworksProvisioningMessage {
   };
 };
 
+/* Added and RSSI changed networks since the last list sent to the peer */
+typedef ListWifiNetworksProvisioningMessage WifiNetworksUpdateProvisioningMessage;
+
 struct UniqueHardwareIdProvisioningMessage {
   ProvisioningMessage c;
   struct {
@@ -163,3 +167,10 @@ union ProvisioningMessageDown {
   struct CommandsProvisioningMessage        provisioningCommands;
   struct NetworkConfigProvisioningMessage   provisioningNetworkConfig;
 };
+
+/* Received messages without the network setting, which is decoded in place in a destination provided by the caller */
+union ProvisioningValueMessageDown {
+  ProvisioningMessage                       c;
+  struct TimestampProvisioningMessage       provisioningTimestamp;
+  struct CommandsProvisioningMessage        provisioningCommands;
+};
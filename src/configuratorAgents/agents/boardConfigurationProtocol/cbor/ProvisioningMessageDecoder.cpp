@@ -0,0 +1,454 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "ANetworkConfigurator_Config.h"
+#if NETWORK_CONFIGURATOR_COMPATIBLE
+
+#include "ProvisioningMessageDecoder.h"
+#include <connectionHandlerModels/settings_default.h>
+#if defined(BOARD_HAS_ETHERNET)
+#include <IPAddress.h>
+#endif
+
+/* CBOR major types */
+#define CBOR_MAJOR_UNSIGNED_INT 0
+#define CBOR_MAJOR_NEGATIVE_INT 1
+#define CBOR_MAJOR_BYTE_STRING  2
+#define CBOR_MAJOR_TEXT_STRING  3
+#define CBOR_MAJOR_ARRAY        4
+#define CBOR_MAJOR_MAP          5
+#define CBOR_MAJOR_TAG          6
+
+/* How a field is read from the payload and written into the message
+ * - TEXT: text string copied as a C string
+ * - UNSIGNED_INT: unsigned integer, ignored if the item is of another type
+ * - INT: signed integer, ignored if the item is of another type
+ * - INT_OR_DEFAULT: integer, the default value is kept if the peer sends -1 or another type
+ * - BAND_MASK: array of band values ORed together, the default value is kept if the array is empty
+ * - DEVICE_CLASS: text string of one char, the default value is kept if the string is empty
+ * - IP_ADDRESS: byte string of 4 (IPv4) or 16 (IPv6) bytes, an empty byte string means DHCP
+ * - DEFAULT: the default value, it doesn't consume an item of the payload
+ */
+enum class FieldType : uint8_t { TEXT,
+                                 UNSIGNED_INT,
+                                 INT,
+                                 INT_OR_DEFAULT,
+                                 BAND_MASK,
+                                 DEVICE_CLASS,
+                                 IP_ADDRESS,
+                                 DEFAULT };
+
+struct FieldSchema {
+  FieldType type;
+  uint16_t offset;
+  uint16_t size;
+};
+
+/* The fields of the messages carrying a network setting are relative to the models::NetworkSetting,
+ * the fields of the other messages (adapter NONE) are relative to the message
+ */
+struct MessageSchema {
+  CBORTag tag;
+  ProvisioningMessageId id;
+  NetworkAdapter adapter;
+  const FieldSchema *fields;
+  uint8_t numFields;
+};
+
+struct CBORCursor {
+  const uint8_t *ptr;
+  const uint8_t *end;
+};
+
+#define MESSAGE_FIELD(fieldType, msgType, member) { FieldType::fieldType, offsetof(msgType, member), sizeof(((msgType *)0)->member) }
+#define NETWORK_FIELD(fieldType, member) MESSAGE_FIELD(fieldType, models::NetworkSetting, member)
+#define MESSAGE_SCHEMA(tag, id, adapter, fields) { tag, id, adapter, fields, sizeof(fields) / sizeof(FieldSchema) }
+
+static constexpr FieldSchema TIMESTAMP_FIELDS[] = {
+  MESSAGE_FIELD(UNSIGNED_INT, TimestampProvisioningMessage, timestamp)
+};
+
+static constexpr FieldSchema COMMANDS_FIELDS[] = {
+  MESSAGE_FIELD(INT, CommandsProvisioningMessage, cmd)
+};
+
+#if defined(BOARD_HAS_WIFI)
+static constexpr FieldSchema WIFI_FIELDS[] = {
+  NETWORK_FIELD(TEXT, wifi.ssid),
+  NETWORK_FIELD(TEXT, wifi.pwd)
+};
+#endif
+
+#if defined(BOARD_HAS_LORA)
+static constexpr FieldSchema LORA_FIELDS[] = {
+  NETWORK_FIELD(TEXT, lora.appeui),
+  NETWORK_FIELD(TEXT, lora.appkey),
+  NETWORK_FIELD(INT_OR_DEFAULT, lora.band),
+  NETWORK_FIELD(TEXT, lora.channelMask),
+  NETWORK_FIELD(DEVICE_CLASS, lora.deviceClass)
+};
+#endif
+
+#if defined(BOARD_HAS_GSM)
+static constexpr FieldSchema GSM_FIELDS[] = {
+  NETWORK_FIELD(TEXT, gsm.pin),
+  NETWORK_FIELD(TEXT, gsm.apn),
+  NETWORK_FIELD(TEXT, gsm.login),
+  NETWORK_FIELD(TEXT, gsm.pass)
+};
+#endif
+
+#if defined(BOARD_HAS_NB)
+static constexpr FieldSchema NB_FIELDS[] = {
+  NETWORK_FIELD(TEXT, nb.pin),
+  NETWORK_FIELD(TEXT, nb.apn),
+  NETWORK_FIELD(TEXT, nb.login),
+  NETWORK_FIELD(TEXT, nb.pass)
+};
+#endif
+
+#if defined(BOARD_HAS_CATM1_NBIOT)
+static constexpr FieldSchema CATM1_FIELDS[] = {
+  NETWORK_FIELD(TEXT, catm1.pin),
+  NETWORK_FIELD(BAND_MASK, catm1.band),
+  NETWORK_FIELD(TEXT, catm1.apn),
+  NETWORK_FIELD(TEXT, catm1.login),
+  NETWORK_FIELD(TEXT, catm1.pass),
+  NETWORK_FIELD(DEFAULT, catm1.rat)
+};
+#endif
+
+#if defined(BOARD_HAS_ETHERNET)
+static constexpr FieldSchema ETHERNET_FIELDS[] = {
+  NETWORK_FIELD(IP_ADDRESS, eth.ip),
+  NETWORK_FIELD(IP_ADDRESS, eth.dns),
+  NETWORK_FIELD(IP_ADDRESS, eth.gateway),
+  NETWORK_FIELD(IP_ADDRESS, eth.netmask),
+  NETWORK_FIELD(INT_OR_DEFAULT, eth.timeout),
+  NETWORK_FIELD(INT_OR_DEFAULT, eth.response_timeout)
+};
+#endif
+
+#if defined(BOARD_HAS_CELLULAR)
+static constexpr FieldSchema CELLULAR_FIELDS[] = {
+  NETWORK_FIELD(TEXT, cell.pin),
+  NETWORK_FIELD(TEXT, cell.apn),
+  NETWORK_FIELD(TEXT, cell.login),
+  NETWORK_FIELD(TEXT, cell.pass)
+};
+#endif
+
+static constexpr MessageSchema MESSAGE_SCHEMAS[] = {
+  MESSAGE_SCHEMA(CBORTimestampProvisioningMessage, TimestampProvisioningMessageId, NetworkAdapter::NONE, TIMESTAMP_FIELDS),
+  MESSAGE_SCHEMA(CBORCommandsProvisioningMessage, CommandsProvisioningMessageId, NetworkAdapter::NONE, COMMANDS_FIELDS),
+#if defined(BOARD_HAS_WIFI)
+  MESSAGE_SCHEMA(CBORWifiConfigProvisioningMessage, WifiConfigProvisioningMessageId, NetworkAdapter::WIFI, WIFI_FIELDS),
+#endif
+#if defined(BOARD_HAS_LORA)
+  MESSAGE_SCHEMA(CBORLoRaConfigProvisioningMessage, LoRaConfigProvisioningMessageId, NetworkAdapter::LORA, LORA_FIELDS),
+#endif
+#if defined(BOARD_HAS_GSM)
+  MESSAGE_SCHEMA(CBORGSMConfigProvisioningMessage, GSMConfigProvisioningMessageId, NetworkAdapter::GSM, GSM_FIELDS),
+#endif
+#if defined(BOARD_HAS_NB)
+  MESSAGE_SCHEMA(CBORNBIOTConfigProvisioningMessage, NBIOTConfigProvisioningMessageId, NetworkAdapter::NB, NB_FIELDS),
+#endif
+#if defined(BOARD_HAS_CATM1_NBIOT)
+  MESSAGE_SCHEMA(CBORCATM1ConfigProvisioningMessage, CATM1ConfigProvisioningMessageId, NetworkAdapter::CATM1, CATM1_FIELDS),
+#endif
+#if defined(BOARD_HAS_ETHERNET)
+  MESSAGE_SCHEMA(CBOREthernetConfigProvisioningMessage, EthernetConfigProvisioningMessageId, NetworkAdapter::ETHERNET, ETHERNET_FIELDS),
+#endif
+#if defined(BOARD_HAS_CELLULAR)
+  MESSAGE_SCHEMA(CBORCellularConfigProvisioningMessage, CellularConfigProvisioningMessageId, NetworkAdapter::CELL, CELLULAR_FIELDS),
+#endif
+};
+
+/* The tags of the received messages are in a small range, the schema of a message is found
+ * with a single index in a table built at compile time. The tags not sent to the board
+ * and the messages of the network adapters not supported by the board map to -1
+ */
+#define FIRST_MESSAGE_TAG CBORTimestampProvisioningMessage
+#define LAST_MESSAGE_TAG  CBORCellularConfigProvisioningMessage
+#define NUM_MESSAGE_SCHEMAS (sizeof(MESSAGE_SCHEMAS) / sizeof(MessageSchema))
+
+// Position in MESSAGE_SCHEMAS of the schema of a tag, -1 if the board doesn't receive the message
+static constexpr int8_t schemaIndexOf(CBORTag tag, size_t i = 0) {
+  return i >= NUM_MESSAGE_SCHEMAS ? -1 : MESSAGE_SCHEMAS[i].tag == tag ? (int8_t)i : schemaIndexOf(tag, i + 1);
+}
+
+#define SCHEMA_INDEX(offset) schemaIndexOf(FIRST_MESSAGE_TAG + (offset))
+
+static constexpr int8_t MESSAGE_SCHEMA_INDEX[] = {
+  SCHEMA_INDEX(0),  SCHEMA_INDEX(1),  SCHEMA_INDEX(2),  SCHEMA_INDEX(3),  SCHEMA_INDEX(4),  SCHEMA_INDEX(5),
+  SCHEMA_INDEX(6),  SCHEMA_INDEX(7),  SCHEMA_INDEX(8),  SCHEMA_INDEX(9),  SCHEMA_INDEX(10), SCHEMA_INDEX(11),
+  SCHEMA_INDEX(12), SCHEMA_INDEX(13), SCHEMA_INDEX(14), SCHEMA_INDEX(15), SCHEMA_INDEX(16)
+};
+
+static_assert(sizeof(MESSAGE_SCHEMA_INDEX) == LAST_MESSAGE_TAG - FIRST_MESSAGE_TAG + 1, "Unexpected range of the received message tags");
+
+/* Reads the header of an item: major type and argument.
+ * The indefinite length items are not used by the peer and are rejected
+ */
+static bool readHeader(CBORCursor &cursor, uint8_t &majorType, uint64_t &arg) {
+  if (cursor.ptr >= cursor.end) {
+    return false;
+  }
+
+  uint8_t initialByte = *cursor.ptr++;
+  majorType = initialByte >> 5;
+  uint8_t info = initialByte & 0x1f;
+  if (info < 24) {
+    arg = info;
+    return true;
+  }
+
+  if (info > 27) {
+    return false;
+  }
+
+  size_t argLen = 1 << (info - 24);
+  if ((size_t)(cursor.end - cursor.ptr) < argLen) {
+    return false;
+  }
+
+  arg = 0;
+  for (size_t i = 0; i < argLen; i++) {
+    arg = (arg << 8) | *cursor.ptr++;
+  }
+  return true;
+}
+
+// Consumes the content of a byte or text string, returns its first byte
+static const uint8_t *readString(CBORCursor &cursor, uint64_t len) {
+  if ((uint64_t)(cursor.end - cursor.ptr) < len) {
+    return nullptr;
+  }
+  const uint8_t *str = cursor.ptr;
+  cursor.ptr += len;
+  return str;
+}
+
+// Returns true if the item is an integer in the range of an int
+static bool getInt(uint8_t majorType, uint64_t arg, int32_t &val) {
+  if ((majorType != CBOR_MAJOR_UNSIGNED_INT && majorType != CBOR_MAJOR_NEGATIVE_INT) || arg > INT32_MAX) {
+    return false;
+  }
+  val = majorType == CBOR_MAJOR_UNSIGNED_INT ? (int32_t)arg : -1 - (int32_t)arg;
+  return true;
+}
+
+// Consumes the content of an item of a type not expected by the field
+static bool skipItem(CBORCursor &cursor, uint8_t majorType, uint64_t arg) {
+  if (majorType == CBOR_MAJOR_BYTE_STRING || majorType == CBOR_MAJOR_TEXT_STRING) {
+    return readString(cursor, arg) != nullptr;
+  }
+  // Nested containers and tags are not expected in place of a number
+  return majorType != CBOR_MAJOR_ARRAY && majorType != CBOR_MAJOR_MAP && majorType != CBOR_MAJOR_TAG;
+}
+
+/* The store functions skip the write if there is no destination: the payload is only validated */
+static void storeInteger(uint8_t *dst, size_t size, uint64_t val) {
+  if (dst == nullptr) {
+    return;
+  }
+
+  switch (size) {
+    case 1: { uint8_t v = val; memcpy(dst, &v, size); } break;
+    case 2: { uint16_t v = val; memcpy(dst, &v, size); } break;
+    case 4: { uint32_t v = val; memcpy(dst, &v, size); } break;
+    default: memcpy(dst, &val, sizeof(val)); break;
+  }
+}
+
+// The defaults are the models::settingsDefault() of the adapter, built once per message
+static void storeDefault(uint8_t *base, const uint8_t *defaults, const FieldSchema &field) {
+  if (base == nullptr || defaults == nullptr) {
+    return;
+  }
+
+  memcpy(base + field.offset, defaults + field.offset, field.size);
+}
+
+static bool decodeField(CBORCursor &cursor, uint8_t *base, const uint8_t *defaults, const FieldSchema &field) {
+  uint8_t *dst = base != nullptr ? base + field.offset : nullptr;
+  uint8_t majorType;
+  uint64_t arg;
+  int32_t val;
+
+  if (field.type == FieldType::DEFAULT) {
+    storeDefault(base, defaults, field);
+    return true;
+  }
+
+  if (!readHeader(cursor, majorType, arg)) {
+    return false;
+  }
+
+  switch (field.type) {
+    case FieldType::TEXT:
+    {
+      // As the copy of tinycbor the string is null terminated only if there is room left
+      const uint8_t *str = majorType == CBOR_MAJOR_TEXT_STRING ? readString(cursor, arg) : nullptr;
+      if (str == nullptr || arg > field.size) {
+        return false;
+      }
+      if (dst == nullptr) {
+        return true;
+      }
+      memcpy(dst, str, arg);
+      if (arg < field.size) {
+        dst[arg] = '\0';
+      }
+      return true;
+    }
+    case FieldType::UNSIGNED_INT:
+      if (majorType == CBOR_MAJOR_UNSIGNED_INT) {
+        storeInteger(dst, field.size, arg);
+        return true;
+      }
+      return skipItem(cursor, majorType, arg);
+    case FieldType::INT:
+      if (getInt(majorType, arg, val)) {
+        storeInteger(dst, field.size, (uint64_t)(int64_t)val);
+        return true;
+      }
+      return skipItem(cursor, majorType, arg);
+    case FieldType::INT_OR_DEFAULT:
+      //if the peer sends -1 we keep the default value. "-1" is used to keep the default value
+      if (getInt(majorType, arg, val) && val >= 0) {
+        storeInteger(dst, field.size, val);
+        return true;
+      }
+      storeDefault(base, defaults, field);
+      return skipItem(cursor, majorType, arg);
+    case FieldType::BAND_MASK:
+    {
+      if (majorType != CBOR_MAJOR_ARRAY || arg > BAND_SIZE) {
+        return false;
+      }
+      if (arg == 0) {
+        storeDefault(base, defaults, field);
+        return true;
+      }
+
+      uint64_t band = 0;
+      for (uint64_t i = 0, numBands = arg; i < numBands; i++) {
+        if (!readHeader(cursor, majorType, arg) || majorType != CBOR_MAJOR_UNSIGNED_INT || arg > INT32_MAX) {
+          return false;
+        }
+        band |= arg;
+      }
+      storeInteger(dst, field.size, band);
+      return true;
+    }
+    case FieldType::DEVICE_CLASS:
+    {
+      const uint8_t *str = majorType == CBOR_MAJOR_TEXT_STRING ? readString(cursor, arg) : nullptr;
+      if (str == nullptr || arg > LORA_DEVICE_CLASS_SIZE) {
+        return false;
+      }
+      if (arg == 0 || str[0] == '\0') {
+        storeDefault(base, defaults, field);
+      } else {
+        storeInteger(dst, field.size, str[0]);
+      }
+      return true;
+    }
+#if defined(BOARD_HAS_ETHERNET)
+    case FieldType::IP_ADDRESS:
+    {
+      const uint8_t *bytes = majorType == CBOR_MAJOR_BYTE_STRING ? readString(cursor, arg) : nullptr;
+      if (bytes == nullptr || (arg != 0 && arg != 4 && arg != 16)) {
+        return false;
+      }
+      //An empty address means DHCP
+      if (dst != nullptr && arg != 0) {
+        models::ip_addr *ip = (models::ip_addr *)dst;
+        ip->type = arg == 4 ? IPType::IPv4 : IPType::IPv6;
+        memcpy(ip->bytes, bytes, arg);
+      }
+      return true;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+static const MessageSchema *findSchema(CBORTag tag) {
+  if (tag < FIRST_MESSAGE_TAG || tag > LAST_MESSAGE_TAG) {
+    return nullptr;
+  }
+  int8_t idx = MESSAGE_SCHEMA_INDEX[tag - FIRST_MESSAGE_TAG];
+  return idx < 0 ? nullptr : &MESSAGE_SCHEMAS[idx];
+}
+
+// The fields not sent by the peer are an error, the extra items are ignored
+static bool decodeFields(CBORCursor cursor, uint64_t numItems, uint8_t *base, const uint8_t *defaults, const MessageSchema &schema) {
+  for (uint8_t i = 0; i < schema.numFields; i++) {
+    const FieldSchema &field = schema.fields[i];
+    if (field.type != FieldType::DEFAULT && numItems-- == 0) {
+      return false;
+    }
+    if (!decodeField(cursor, base, defaults, field)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* The fields of the timestamp and commands messages are offsets from the first member of the message,
+ * which every message of the ProvisioningMessageDown and ProvisioningValueMessageDown unions shares.
+ */
+static MessageDecoder::Status decodeMessage(ProvisioningMessage *msg, models::NetworkSetting *netSetting, const uint8_t *data, size_t len) {
+  CBORCursor cursor = { data, data + len };
+  uint8_t majorType;
+  uint64_t arg;
+
+  if (!readHeader(cursor, majorType, arg) || majorType != CBOR_MAJOR_TAG) {
+    return MessageDecoder::Status::Error;
+  }
+
+  const MessageSchema *schema = findSchema(arg);
+  if (schema == nullptr) {
+    return MessageDecoder::Status::Error;
+  }
+
+  if (!readHeader(cursor, majorType, arg) || majorType != CBOR_MAJOR_ARRAY) {
+    return MessageDecoder::Status::Error;
+  }
+
+  msg->id = schema->id;
+  if (schema->adapter == NetworkAdapter::NONE) {
+    return decodeFields(cursor, arg, (uint8_t *)msg, nullptr, *schema) ? MessageDecoder::Status::Complete : MessageDecoder::Status::Error;
+  }
+
+  if (netSetting == nullptr) {
+    return decodeFields(cursor, arg, nullptr, nullptr, *schema) ? MessageDecoder::Status::Complete : MessageDecoder::Status::Error;
+  }
+
+  models::NetworkSetting defaults = models::settingsDefault(schema->adapter);
+  memset(netSetting, 0x00, sizeof(models::NetworkSetting));
+  netSetting->type = schema->adapter;
+  if (!decodeFields(cursor, arg, (uint8_t *)netSetting, (const uint8_t *)&defaults, *schema)) {
+    // The fields already written are partial, the setting is marked as not valid
+    netSetting->type = NetworkAdapter::NONE;
+    return MessageDecoder::Status::Error;
+  }
+  return MessageDecoder::Status::Complete;
+}
+
+MessageDecoder::Status ProvisioningMessageDecoder::decode(ProvisioningMessageDown *msg, const uint8_t *data, size_t len) {
+  return decodeMessage(&msg->c, &msg->provisioningNetworkConfig.networkSetting, data, len);
+}
+
+MessageDecoder::Status ProvisioningMessageDecoder::decode(ProvisioningValueMessageDown *msg, models::NetworkSetting *netSetting, const uint8_t *data, size_t len) {
+  return decodeMessage(&msg->c, netSetting, data, len);
+}
+
+#endif // NETWORK_CONFIGURATOR_COMPATIBLE
@@ -0,0 +1,33 @@
+/*
+  Copyright (c) 2024 Arduino SA
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "ProvisioningMessage.h"
+#include <cbor/MessageDecoder.h>
+
+/* Decoder of the messages received from the peer.
+ * Every message has a fixed shape: a tag followed by an array of fields. The fields of each message are
+ * described by a schema and the payload is walked once, writing each field straight into its destination
+ * without the per field validation and copies of the generic CBORMessageDecoder.
+ */
+class ProvisioningMessageDecoder {
+public:
+  static MessageDecoder::Status decode(ProvisioningMessageDown *msg, const uint8_t *data, size_t len);
+  /* Decodes a received network setting in place in netSetting, msg gets the id of the message
+   * or the value of the timestamp and commands messages.
+   * The payload is walked once, writing straight into netSetting: an invalid message leaves netSetting
+   * partially written with type NetworkAdapter::NONE.
+   * If netSetting is nullptr the network setting is only validated
+   */
+  static MessageDecoder::Status decode(ProvisioningValueMessageDown *msg, models::NetworkSetting *netSetting, const uint8_t *data, size_t len);
+private:
+  ProvisioningMessageDecoder();
+};